@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#ifndef _WIN32
+#include <execinfo.h>
+#endif
+#include <substrate/utility>
+#include "backtrace.hxx"
+
+namespace crunch
+{
+#ifndef _WIN32
+	std::string formatBacktrace()
+	{
+		std::string result{"---- BEGIN STACK TRACE ----\n"};
+		std::array<void *, 256> calls{};
+		const auto count{backtrace(calls.data(), int(calls.size()))};
+		auto **symbols = backtrace_symbols(calls.data(), count);
+		for (int i{}; i < count && symbols; ++i)
+		{
+			const auto demangledSymbol{substrate::decode_typename(symbols[i])};
+			std::array<char, 24> address{};
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			snprintf(address.data(), address.size(), "%#018" PRIxPTR, reinterpret_cast<uintptr_t>(calls[i]));
+			result += "\t[";
+			result += address.data();
+			result += "]\t";
+			result += demangledSymbol;
+			result += '\n';
+		}
+		// NOLINTNEXTLINE(cppcoreguidelines-no-malloc,cppcoreguidelines-owning-memory)
+		free(symbols);
+		result += "----- END STACK TRACE -----\n";
+		return result;
+	}
+#else
+	std::string formatBacktrace() { return {}; }
+#endif
+} // namespace crunch
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef BACKTRACE__HXX
+#define BACKTRACE__HXX
+
+#include <string>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// Formats the calling thread's stack, demangling symbols where possible. This allocates,
+	// so is only fit for signal handlers that are about to end the process anyway.
+	CRUNCHpp_API std::string formatBacktrace();
+} // namespace crunch
+
+#endif /*BACKTRACE__HXX*/
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <array>
+#include <mutex>
+#ifndef _WIN32
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+#else
+#include <io.h>
+#endif
+#include "capture.hxx"
+
+namespace crunch
+{
+	bool captureTestOutput{false};
+	FILE *consoleStream{nullptr};
+
+	// Held from beginCapture() to endCapture() by the thread whose test is being captured
+	static std::mutex captureLock{};
+	// The buffer output is going to, and the descriptors stdout and stderr had before, while capturing
+	static int captureFD{-1};
+	static int savedStdout{-1};
+	static int savedStderr{-1};
+
+	bool startCapturing() noexcept
+	{
+		if (consoleStream)
+			return true;
+		fflush(stdout);
+		const auto fd{dup(fileno(stdout))};
+		if (fd == -1)
+			return false;
+		consoleStream = fdopen(fd, "w");
+		if (!consoleStream)
+		{
+			close(fd);
+			return false;
+		}
+		return true;
+	}
+
+	// Makes the buffer to capture into, in memory where we can
+	static int makeBuffer() noexcept
+	{
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+		const auto fd{memfd_create("crunch++ test output", MFD_CLOEXEC)};
+		if (fd != -1)
+			return fd;
+#endif
+		auto *const file{tmpfile()};
+		if (!file)
+			return -1;
+		const auto tmpFD{dup(fileno(file))};
+		fclose(file);
+		return tmpFD;
+	}
+
+	// Puts stdout and stderr back to where they were before beginCapture()
+	static void restoreOutput() noexcept
+	{
+		dup2(savedStdout, fileno(stdout));
+		dup2(savedStderr, fileno(stderr));
+		close(savedStdout);
+		close(savedStderr);
+		savedStdout = -1;
+		savedStderr = -1;
+	}
+
+	bool beginCapture() noexcept
+	{
+		if (!captureTestOutput || !consoleStream || !captureLock.try_lock())
+			return false;
+		fflush(stdout);
+		fflush(stderr);
+		captureFD = makeBuffer();
+		savedStdout = dup(fileno(stdout));
+		savedStderr = dup(fileno(stderr));
+		if (captureFD == -1 || savedStdout == -1 || savedStderr == -1 ||
+			dup2(captureFD, fileno(stdout)) == -1 || dup2(captureFD, fileno(stderr)) == -1)
+		{
+			if (savedStdout != -1 && savedStderr != -1)
+				restoreOutput();
+			for (auto *const fd : {&captureFD, &savedStdout, &savedStderr})
+			{
+				if (*fd != -1)
+					close(*fd);
+				*fd = -1;
+			}
+			captureLock.unlock();
+			return false;
+		}
+		return true;
+	}
+
+	std::string endCapture()
+	{
+		if (captureFD == -1)
+			return {};
+		fflush(stdout);
+		fflush(stderr);
+		restoreOutput();
+		std::string output{};
+		std::array<char, 4096> buffer{};
+		if (lseek(captureFD, 0, SEEK_SET) == 0)
+		{
+			while (true)
+			{
+				const auto count{read(captureFD, buffer.data(), buffer.size())};
+				if (count <= 0)
+					break;
+				output.append(buffer.data(), std::size_t(count));
+			}
+		}
+		close(captureFD);
+		captureFD = -1;
+		captureLock.unlock();
+		return output;
+	}
+
+	std::string formatCapture(const std::string &output)
+	{
+		if (output.empty())
+			return {};
+		std::string result{"Captured output:\n"};
+		result += output;
+		if (result.back() != '\n')
+			result += '\n';
+		return result;
+	}
+
+	void abandonCapture() noexcept
+	{
+		if (captureFD == -1 || savedStdout == -1)
+			return;
+		const auto fd{captureFD};
+		captureFD = -1;
+		restoreOutput();
+		std::array<char, 4096> buffer{};
+		if (lseek(fd, 0, SEEK_SET) == 0)
+		{
+			while (true)
+			{
+				const auto count{read(fd, buffer.data(), buffer.size())};
+				if (count <= 0 || write(fileno(stdout), buffer.data(), std::size_t(count)) != count)
+					break;
+			}
+		}
+		close(fd);
+	}
+} // namespace crunch
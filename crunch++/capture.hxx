@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef CAPTURE__HXX
+#define CAPTURE__HXX
+
+#include <cstdio>
+#include <string>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// Whether to capture what each test writes to stdout and stderr, printing it only if the test fails
+	CRUNCHpp_API bool captureTestOutput;
+	// Where the runner's own output goes when it has a copy of stdout to itself, or nullptr if it doesn't
+	CRUNCHpp_API FILE *consoleStream;
+
+	// Gives the runner its own copy of stdout to write to so its output is never captured or redirected
+	// along with a test's. Returns false if that was not possible.
+	CRUNCHpp_API bool startCapturing() noexcept;
+	// Redirects stdout and stderr into an in-memory buffer for the test about to be run on the calling
+	// thread. As the redirection is process-wide, only one test may be captured at a time: returns
+	// false if capturing is off, another test is already being captured, or the buffer can't be made.
+	bool beginCapture() noexcept;
+	// Puts stdout and stderr back and returns what was captured since beginCapture(), if anything
+	std::string endCapture();
+	// Formats captured output for printing after a test's failure, or returns nothing if there was none
+	std::string formatCapture(const std::string &output);
+	// Puts stdout and stderr back and copies what was captured straight to them, for use when the
+	// test crashed. Only uses async-signal-safe calls.
+	CRUNCHpp_API void abandonCapture() noexcept;
+} // namespace crunch
+
+#endif /*CAPTURE__HXX*/
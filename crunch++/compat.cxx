@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// The entry points test libraries built against older versions of crunch++ call that testsuite no longer
+// declares out-of-line, defined here under the symbols they were exported as so the class itself reads the
+// same in every translation unit
+#include <cstdint>
+#include <type_traits>
+#include "crunch++.h"
+
+// Names a function by the symbol an old member function of testsuite was exported as. The shims take the
+// suite as their first parameter, which is where the Itanium C++ ABI passes this to a member function.
+#if defined(__GNUC__)
+#define CRUNCHpp_COMPAT_LABEL_(prefix) #prefix
+#define CRUNCHpp_COMPAT_LABEL(prefix) CRUNCHpp_COMPAT_LABEL_(prefix)
+#define CRUNCHpp_COMPAT_SYMBOL(symbol) __asm__(CRUNCHpp_COMPAT_LABEL(__USER_LABEL_PREFIX__) symbol)
+
+// How int64_t and uint64_t are mangled, which depends on which of long and long long they are
+#if defined(__APPLE__) || __SIZEOF_LONG__ != 8
+#define CRUNCHpp_COMPAT_INT64 "x"
+#define CRUNCHpp_COMPAT_UINT64 "y"
+static_assert(std::is_same<int64_t, long long>::value && std::is_same<uint64_t, unsigned long long>::value,
+	"int64_t and uint64_t must be long long and unsigned long long for their assertions to be named correctly");
+#else
+#define CRUNCHpp_COMPAT_INT64 "l"
+#define CRUNCHpp_COMPAT_UINT64 "m"
+static_assert(std::is_same<int64_t, long>::value && std::is_same<uint64_t, unsigned long>::value,
+	"int64_t and uint64_t must be long and unsigned long for their assertions to be named correctly");
+#endif
+#endif
+
+namespace crunch
+{
+	namespace compat
+	{
+		using namespace crunch::internal;
+
+		// Gets at what testsuite keeps protected for the tests deriving from it
+		struct testsuite_t : testsuite
+		{
+			using testsuite::registerMacroTest;
+		};
+
+#ifdef CRUNCHpp_MANIFEST
+		// testsuite::registerTest(std::function<void ()> &&, const char *), which is defined inline
+		// where there's a manifest so that tests registered through it mark the manifest as incomplete
+		CRUNCH_VIS bool registerTest(testsuite *suite, std::function<void ()> &&func, const char *name)
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite12registerTestEOSt8functionIFvvEEPKc");
+		bool registerTest(testsuite *const suite, std::function<void ()> &&func, const char *const name)
+			{ return (suite->*&testsuite_t::registerMacroTest)(std::move(func), name, nullptr); }
+#endif
+
+#if defined(__GNUC__)
+		// The assertions, which are now defined inline in testsuite. These repeat their checks rather than
+		// calling them, as calling one that isn't inlined would define the very symbol its shim is named by.
+		CRUNCH_VIS void assertTrue(testsuite *suite, bool value) CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite10assertTrueEb");
+		void assertTrue(testsuite *, const bool value) { if (!value) booleanFailure(value); }
+		CRUNCH_VIS void assertFalse(testsuite *suite, bool value) CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite11assertFalseEb");
+		void assertFalse(testsuite *, const bool value) { if (value) booleanFailure(value); }
+
+// Defines the shims for assertEqual() and assertNotEqual() on the type given, mangled as mangled,
+// which compare their values as compared, a type the failure functions take
+#define CRUNCHpp_COMPAT_EQUALITY(type, mangled, compared) \
+		CRUNCH_VIS void assertEqual(testsuite *suite, type result, type expected) \
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite11assertEqualE" mangled mangled); \
+		void assertEqual(testsuite *, const type result, const type expected) \
+			{ if (result != expected) equalFailure(compared(result), compared(expected)); } \
+		CRUNCH_VIS void assertNotEqual(testsuite *suite, type result, type expected) \
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite14assertNotEqualE" mangled mangled); \
+		void assertNotEqual(testsuite *, const type result, const type expected) \
+			{ if (result == expected) notEqualFailure(compared(result)); }
+
+		CRUNCHpp_COMPAT_EQUALITY(int8_t, "a", int64_t)
+		CRUNCHpp_COMPAT_EQUALITY(uint8_t, "h", uint64_t)
+		CRUNCHpp_COMPAT_EQUALITY(int16_t, "s", int64_t)
+		CRUNCHpp_COMPAT_EQUALITY(uint16_t, "t", uint64_t)
+		CRUNCHpp_COMPAT_EQUALITY(int32_t, "i", int64_t)
+		CRUNCHpp_COMPAT_EQUALITY(uint32_t, "j", uint64_t)
+		CRUNCHpp_COMPAT_EQUALITY(int64_t, CRUNCHpp_COMPAT_INT64, int64_t)
+		CRUNCHpp_COMPAT_EQUALITY(uint64_t, CRUNCHpp_COMPAT_UINT64, uint64_t)
+#if defined(__APPLE__)
+		CRUNCHpp_COMPAT_EQUALITY(std::size_t, "m", uint64_t)
+#endif
+#undef CRUNCHpp_COMPAT_EQUALITY
+
+		CRUNCH_VIS void assertEqual(testsuite *suite, void *result, void *expected)
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite11assertEqualEPvS0_");
+		void assertEqual(testsuite *, void *const result, void *const expected)
+			{ if (result != expected) equalFailure(result, expected); }
+		CRUNCH_VIS void assertNotEqual(testsuite *suite, void *result, void *expected)
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite14assertNotEqualEPvS0_");
+		void assertNotEqual(testsuite *, void *const result, void *const expected)
+			{ if (result == expected) notEqualFailure(result); }
+
+		CRUNCH_VIS void assertEqual(testsuite *suite, double result, double expected)
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite11assertEqualEdd");
+		void assertEqual(testsuite *, const double result, const double expected)
+			{ if (!withinDelta(result, expected)) equalFailure(result, expected); }
+		CRUNCH_VIS void assertNotEqual(testsuite *suite, double result, double expected)
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite14assertNotEqualEdd");
+		void assertNotEqual(testsuite *, const double result, const double expected)
+			{ if (withinDelta(result, expected)) notEqualFailure(result); }
+
+		CRUNCH_VIS void assertNull(testsuite *suite, const void *result) CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite10assertNullEPKv");
+		void assertNull(testsuite *, const void *const result) { if (result != nullptr) nullFailure(result); }
+		CRUNCH_VIS void assertNotNull(testsuite *suite, const void *result)
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite13assertNotNullEPKv");
+		void assertNotNull(testsuite *, const void *const result) { if (result == nullptr) notNullFailure(); }
+
+		CRUNCH_VIS void assertGreaterThan(testsuite *suite, long result, long expected)
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite17assertGreaterThanEll");
+		void assertGreaterThan(testsuite *, const long result, const long expected)
+			{ if (result <= expected) greaterThanFailure(result, expected); }
+		CRUNCH_VIS void assertLessThan(testsuite *suite, long result, long expected)
+			CRUNCHpp_COMPAT_SYMBOL("_ZN9testsuite14assertLessThanEll");
+		void assertLessThan(testsuite *, const long result, const long expected)
+			{ if (result >= expected) lessThanFailure(result, expected); }
+#endif
+	} // namespace compat
+} // namespace crunch
@@ -1,22 +1,38 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
 #include <cstring>
 #include <cinttypes>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 #include "crunch++.h"
 #include "core.hxx"
 #include "logger.hxx"
+#include "isolation.hxx"
+#include "filter.hxx"
 #include "stringFuncs.hxx"
 
-constexpr static double doubleDelta = 0.0000001;
+// How many elements either side of the first difference assertRangeEqual() shows
+constexpr static std::size_t rangeContext{3};
+// How many bytes each line of a buffer hexdump shows, and how many lines either side of the
+// line with the first difference in it the failure of assertEqual() on buffers shows
+constexpr static std::size_t hexdumpWidth{16};
+constexpr static std::size_t hexdumpContext{2};
 
 namespace crunch
 {
-	uint32_t passes = 0, failures = 0;
+	uint32_t maxFailures{0};
 
-	template<typename T>
-	void assertionFailure(const char *what, T result, T expected)
+	bool failureLimitReached() noexcept
+		{ return maxFailures && results.failures >= maxFailures; }
+
+	template<typename... values_t>
+	void assertionFailure(const char *what, values_t ...values)
 	{
 		auto mesg = formatString("Assertion failure: %s", what);
-		logResult(RESULT_FAILURE, mesg.get(), result, expected);
+		logResult(RESULT_FAILURE, mesg.get(), values...);
 	}
 
 	template<typename T>
@@ -36,6 +52,249 @@ namespace crunch
 		auto what = formatString("did not expect %s", params);
 		assertionFailure(what.get(), result, result);
 	}
+
+	namespace internal
+	{
+		void booleanFailure(const bool value)
+		{
+			assertionError("%s", boolToString(value), boolToString(!value));
+			throw threadExit_t{1};
+		}
+
+		void equalFailure(const int64_t result, const int64_t expected)
+		{
+			assertionError("%" PRId64, result, expected);
+			throw threadExit_t{1};
+		}
+
+		void equalFailure(const uint64_t result, const uint64_t expected)
+		{
+			assertionError("%" PRIu64, result, expected);
+			throw threadExit_t{1};
+		}
+
+		void equalFailure(const double result, const double expected)
+		{
+			assertionError("%f", result, expected);
+			throw threadExit_t{1};
+		}
+
+		void equalFailure(const void *const result, const void *const expected)
+		{
+			assertionError("%p", result, expected);
+			throw threadExit_t{1};
+		}
+
+		void printedEqualFailure(const std::string &result, const std::string &expected)
+		{
+			assertionError("%s", result.c_str(), expected.c_str());
+			throw threadExit_t{1};
+		}
+
+		void notEqualFailure(const int64_t result)
+		{
+			assertionError("%" PRId64, result);
+			throw threadExit_t{1};
+		}
+
+		void notEqualFailure(const uint64_t result)
+		{
+			assertionError("%" PRIu64, result);
+			throw threadExit_t{1};
+		}
+
+		void notEqualFailure(const double result)
+		{
+			assertionError("%f", result);
+			throw threadExit_t{1};
+		}
+
+		void notEqualFailure(const void *const result)
+		{
+			assertionError("%p", result);
+			throw threadExit_t{1};
+		}
+
+		void printedNotEqualFailure(const std::string &result)
+		{
+			assertionError("%s", result.c_str());
+			throw threadExit_t{1};
+		}
+
+		void nullFailure(const void *const result)
+		{
+			assertionError("%p", result, nullptr);
+			throw threadExit_t{1};
+		}
+
+		void notNullFailure()
+		{
+			assertionError("%p", static_cast<const void *>(nullptr));
+			throw threadExit_t{1};
+		}
+
+		void greaterThanFailure(const long result, const long expected)
+		{
+			assertionFailure("%ld was not greater than %ld", result, expected);
+			throw threadExit_t{1};
+		}
+
+		void lessThanFailure(const long result, const long expected)
+		{
+			assertionFailure("%ld was not less than %ld", result, expected);
+			throw threadExit_t{1};
+		}
+
+		std::size_t firstMismatch(const void *const result, const void *const expected, const std::size_t length) noexcept
+		{
+			const auto *const lhs{static_cast<const uint8_t *>(result)};
+			const auto *const rhs{static_cast<const uint8_t *>(expected)};
+			std::size_t offset{0};
+			// Compare 16 bytes at a time until a block with a difference in it turns up
+#if defined(__SSE2__)
+			for (; offset + 16U <= length; offset += 16U)
+			{
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				const auto lhsBlock{_mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + offset))};
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				const auto rhsBlock{_mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + offset))};
+				const auto equal{uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(lhsBlock, rhsBlock)))};
+				if (equal != 0xFFFFU)
+					return offset + std::size_t(__builtin_ctz(~equal));
+			}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+			for (; offset + 16U <= length; offset += 16U)
+			{
+				if (vminvq_u8(vceqq_u8(vld1q_u8(lhs + offset), vld1q_u8(rhs + offset))) != 0xFFU)
+					break;
+			}
+#endif
+			for (; offset < length; ++offset)
+			{
+				if (lhs[offset] != rhs[offset])
+					return offset;
+			}
+			return length;
+		}
+
+		template<typename T> static T readElement(const uint8_t *const element) noexcept
+		{
+			T value{};
+			memcpy(&value, element, sizeof(T));
+			return value;
+		}
+
+		static std::string describeElement(const void *const range, const std::size_t index,
+			const std::size_t elementSize, const elementKind_t kind)
+		{
+			const auto *const element{static_cast<const uint8_t *>(range) + index * elementSize};
+			if (kind == elementKind_t::pointer)
+				return formatString("%p", readElement<const void *>(element)).get();
+			else if (kind == elementKind_t::signedInteger)
+			{
+				const int64_t value{elementSize == 1 ? readElement<int8_t>(element) :
+					elementSize == 2 ? readElement<int16_t>(element) :
+					elementSize == 4 ? readElement<int32_t>(element) : readElement<int64_t>(element)};
+				return formatString("%" PRId64, value).get();
+			}
+			const uint64_t value{elementSize == 1 ? readElement<uint8_t>(element) :
+				elementSize == 2 ? readElement<uint16_t>(element) :
+				elementSize == 4 ? readElement<uint32_t>(element) : readElement<uint64_t>(element)};
+			return formatString("%" PRIu64, value).get();
+		}
+
+		void rangeFailure(const void *const result, const void *const expected, const std::size_t count,
+			const std::size_t index, const std::size_t elementSize, const elementKind_t kind)
+		{
+			assertionFailure("ranges first differ at index %zu, expected %s, got %s", index,
+				describeElement(expected, index, elementSize, kind).c_str(),
+				describeElement(result, index, elementSize, kind).c_str());
+			// Show the elements either side of the difference too, marking those that differ
+			const auto begin{index > rangeContext ? index - rangeContext : 0};
+			const auto end{std::min(count, index + rangeContext + 1)};
+			for (auto element{begin}; element < end; ++element)
+			{
+				const auto expectedValue{describeElement(expected, element, elementSize, kind)};
+				const auto resultValue{describeElement(result, element, elementSize, kind)};
+				if (expectedValue == resultValue)
+					testPrintf("\t  [%zu] %s", element, expectedValue.c_str());
+				else
+					testPrintf("\t> [%zu] expected %s, got %s", element, expectedValue.c_str(), resultValue.c_str());
+				newline();
+			}
+			throw threadExit_t{1};
+		}
+
+		void rangeLengthFailure(const std::size_t resultCount, const std::size_t expectedCount)
+		{
+			assertionFailure("ranges differ in length, expected %zu elements, got %zu", expectedCount, resultCount);
+			throw threadExit_t{1};
+		}
+
+		// Counts how many bytes differ between two blocks of memory
+		static std::size_t countMismatches(const uint8_t *const result, const uint8_t *const expected,
+			const std::size_t length) noexcept
+		{
+			std::size_t offset{0};
+			std::size_t mismatches{0};
+#if defined(__SSE2__)
+			for (; offset + 16U <= length; offset += 16U)
+			{
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				const auto resultBlock{_mm_loadu_si128(reinterpret_cast<const __m128i *>(result + offset))};
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				const auto expectedBlock{_mm_loadu_si128(reinterpret_cast<const __m128i *>(expected + offset))};
+				const auto equal{uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(resultBlock, expectedBlock)))};
+				mismatches += std::size_t(__builtin_popcount(~equal & 0xFFFFU));
+			}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+			for (; offset + 16U <= length; offset += 16U)
+			{
+				// Each byte that differs comes out of the compare as 0, so add up the 1s left by those that match
+				const auto equal{vshrq_n_u8(vceqq_u8(vld1q_u8(result + offset), vld1q_u8(expected + offset)), 7)};
+				mismatches += 16U - vaddvq_u8(equal);
+			}
+#endif
+			for (; offset < length; ++offset)
+				mismatches += result[offset] != expected[offset] ? 1U : 0U;
+			return mismatches;
+		}
+
+		// Writes out one line of a hexdump of a buffer, leaving blanks for the bytes past its end
+		static std::string hexdumpLine(const uint8_t *const buffer, const std::size_t offset, const std::size_t length)
+		{
+			std::string line{};
+			line.reserve(hexdumpWidth * 3U);
+			for (std::size_t byte{offset}; byte < offset + hexdumpWidth; ++byte)
+				line += byte < length ? formatString("%02x ", buffer[byte]).get() : "   ";
+			return line;
+		}
+
+		[[noreturn]] CRUNCH_COLD static void bufferFailure(const void *const result, const void *const expected,
+			const std::size_t length)
+		{
+			const auto *const resultBytes{static_cast<const uint8_t *>(result)};
+			const auto *const expectedBytes{static_cast<const uint8_t *>(expected)};
+			const auto offset{firstMismatch(result, expected, length)};
+			assertionFailure("buffers %p and %p first differ at offset %zu, %zu of %zu bytes differ", result, expected,
+				offset, countMismatches(resultBytes, expectedBytes, length), length);
+			// Dump the region around the first difference side by side, marking the lines that differ
+			const auto firstLine{offset / hexdumpWidth};
+			const auto begin{(firstLine > hexdumpContext ? firstLine - hexdumpContext : 0) * hexdumpWidth};
+			const auto end{std::min(length, (firstLine + hexdumpContext + 1U) * hexdumpWidth)};
+			testPrintf("\t  offset    %-*s %s", int(hexdumpWidth * 3U), "expected", "result");
+			newline();
+			for (auto line{begin}; line < end; line += hexdumpWidth)
+			{
+				const auto lineLength{std::min(hexdumpWidth, length - line)};
+				const auto differs{std::memcmp(resultBytes + line, expectedBytes + line, lineLength) != 0};
+				testPrintf("\t%c %08zx  %s %s", differs ? '>' : ' ', line,
+					hexdumpLine(expectedBytes, line, length).c_str(), hexdumpLine(resultBytes, line, length).c_str());
+				newline();
+			}
+			throw threadExit_t{1};
+		}
+	} // namespace internal
 } // namespace crunch
 
 using crunch::assertionFailure;
@@ -43,9 +302,14 @@ using crunch::assertionError;
 using crunch::logResult;
 using crunch::RESULT_FAILURE;
 using crunch::RESULT_SKIP;
+using namespace crunch::internal;
 
 testsuite::testsuite() noexcept = default;
-testsuite::~testsuite() noexcept = default;
+testsuite::~testsuite() noexcept
+{
+	crunch::forgetTimeouts(*this);
+	crunch::forgetTags(*this);
+}
 
 void testsuite::fail(const char *const reason)
 {
@@ -59,228 +323,6 @@ void testsuite::skip(const char *const reason)
 	throw threadExit_t{1};
 }
 
-void testsuite::assertTrue(const bool value)
-{
-	if (!value)
-	{
-		assertionError("%s", boolToString(value), "true");
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertFalse(const bool value)
-{
-	if (value)
-	{
-		assertionError("%s", boolToString(value), "false");
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertEqual(const int8_t result, const int8_t expected)
-{
-	if (result != expected)
-	{
-		assertionError("%d", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const int8_t result, const int8_t expected)
-{
-	if (result == expected)
-	{
-		assertionError("%d", result);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertEqual(const uint8_t result, const uint8_t expected)
-{
-	if (result != expected)
-	{
-		assertionError("%u", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const uint8_t result, const uint8_t expected)
-{
-	if (result == expected)
-	{
-		assertionError("%u", result);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertEqual(const int16_t result, const int16_t expected)
-{
-	if (result != expected)
-	{
-		assertionError("%d", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const int16_t result, const int16_t expected)
-{
-	if (result == expected)
-	{
-		assertionError("%d", result);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertEqual(const uint16_t result, const uint16_t expected)
-{
-	if (result != expected)
-	{
-		assertionError("%u", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const uint16_t result, const uint16_t expected)
-{
-	if (result == expected)
-	{
-		assertionError("%u", result);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertEqual(const int32_t result, const int32_t expected)
-{
-	if (result != expected)
-	{
-		assertionError("%d", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const int32_t result, const int32_t expected)
-{
-	if (result == expected)
-	{
-		assertionError("%d", result);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertEqual(const uint32_t result, const uint32_t expected)
-{
-	if (result != expected)
-	{
-		assertionError("%u", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const uint32_t result, const uint32_t expected)
-{
-	if (result == expected)
-	{
-		assertionError("%u", result);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertEqual(const int64_t result, const int64_t expected)
-{
-	if (result != expected)
-	{
-		assertionError("%" PRId64, result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const int64_t result, const int64_t expected)
-{
-	if (result == expected)
-	{
-		assertionError("%" PRId64, result);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertEqual(const uint64_t result, const uint64_t expected)
-{
-	if (result != expected)
-	{
-		assertionError("%" PRIu64, result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const uint64_t result, const uint64_t expected)
-{
-	if (result == expected)
-	{
-		assertionError("%" PRIu64, result);
-		throw threadExit_t{1};
-	}
-}
-#if defined(__APPLE__)
-void testsuite::assertEqual(const std::size_t result, const std::size_t expected)
-{
-	if (result != expected)
-	{
-		assertionError("%zu", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const std::size_t result, const std::size_t expected)
-{
-	if (result == expected)
-	{
-		assertionError("%zu", result);
-		throw threadExit_t{1};
-	}
-}
-#endif
-
-void testsuite::assertEqual(void *result, void *expected)
-{
-	if (result != expected)
-	{
-		assertionError("%p", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(void *result, void *expected)
-{
-	if (result == expected)
-	{
-		assertionError("%p", result);
-		throw threadExit_t{1};
-	}
-}
-
-inline bool delta(const double result, const double expected)
-{
-	return (result >= (expected - doubleDelta) && result <= (expected + doubleDelta));
-}
-
-void testsuite::assertEqual(const double result, const double expected)
-{
-	if (!delta(result, expected))
-	{
-		assertionError("%f", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotEqual(const double result, const double expected)
-{
-	if (delta(result, expected))
-	{
-		assertionError("%f", result);
-		throw threadExit_t{1};
-	}
-}
-
 void testsuite::assertEqual(const char *const result, const char *const expected)
 {
 	if (std::strcmp(result, expected) != 0)
@@ -319,11 +361,9 @@ void testsuite::assertNotEqual(const stringView result, const stringView expecte
 
 void testsuite::assertEqual(const void *result, const void *expected, const size_t expectedLength)
 {
+	// memcmp() is as fast as it gets for buffers that match, so the difference is only looked for once there is one
 	if (std::memcmp(result, expected, expectedLength) != 0)
-	{
-		assertionFailure("buffers %p and %p do not match", result, expected);
-		throw threadExit_t{1};
-	}
+		bufferFailure(result, expected, expectedLength);
 }
 
 void testsuite::assertNotEqual(const void *result, const void *expected, const size_t expectedLength)
@@ -334,39 +374,3 @@ void testsuite::assertNotEqual(const void *result, const void *expected, const s
 		throw threadExit_t{1};
 	}
 }
-
-void testsuite::assertNull(const void *const result)
-{
-	if (result != nullptr)
-	{
-		assertionError("%p", result, nullptr);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertNotNull(const void *const result)
-{
-	if (result == nullptr)
-	{
-		assertionError("%p", result);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertGreaterThan(const long result, const long expected)
-{
-	if (result <= expected)
-	{
-		assertionFailure("%ld was not greater than %ld", result, expected);
-		throw threadExit_t{1};
-	}
-}
-
-void testsuite::assertLessThan(const long result, const long expected)
-{
-	if (result >= expected)
-	{
-		assertionFailure("%ld was not less than %ld", result, expected);
-		throw threadExit_t{1};
-	}
-}
@@ -4,26 +4,37 @@
 
 #include <utility>
 #include "crunch++.h"
+#include "results.hxx"
 
 namespace crunch
 {
+	// A registered test class, which is constructed only once something asks for its suite if it was
+	// registered with a factory, so suites whose tests never get run never do the work of constructing
 	struct cxxTestClass final
 	{
 	private:
 		std::unique_ptr<testsuite> suite_{};
+		internal::suiteFactory_t factory_{nullptr};
 		const char *name_{nullptr};
 
 	public:
 		cxxTestClass() noexcept : suite_{}, name_{nullptr} { }
 		cxxTestClass(std::unique_ptr<testsuite> &&suite, const char *const name) :
 			suite_{std::move(suite)}, name_{name} { }
+		cxxTestClass(const internal::suiteFactory_t factory, const char *const name) noexcept :
+			factory_{factory}, name_{name} { }
 		cxxTestClass(const cxxTestClass &) = delete;
 		cxxTestClass(cxxTestClass &&) = default;
 		~cxxTestClass() noexcept = default;
 		cxxTestClass &operator =(const cxxTestClass &) = delete;
 		cxxTestClass &operator =(cxxTestClass &&) = default;
 
-		testsuite *suite() const noexcept { return suite_.get(); }
+		testsuite *suite()
+		{
+			if (!suite_ && factory_)
+				suite_ = factory_();
+			return suite_.get();
+		}
 		const char *name() const noexcept { return name_; }
 
 		void swap(cxxTestClass &other) noexcept
@@ -34,9 +45,33 @@ namespace crunch
 		}
 	};
 
-	CRUNCHpp_API uint32_t passes, failures;
+	// How many failures the run may reach before no more tests are started, or 0 for no limit
+	CRUNCHpp_API uint32_t maxFailures;
+	CRUNCHpp_API bool failureLimitReached() noexcept;
 	CRUNCHpp_API bool loggingTests;
+	// Whether the tests that would be run are to be listed rather than run
+	CRUNCHpp_API bool listingTests;
+	CRUNCHpp_API uint32_t testJobs;
 	CRUNCHpp_API std::vector<cxxTestClass> cxxTests;
+
+	// Redirects test class registration on the calling thread into context, or back into
+	// cxxTests if context is nullptr, so several test libraries can be registered at once
+	CRUNCHpp_API void registrationContext(std::vector<cxxTestClass> *context) noexcept;
+
+	// A test noted as its test library was loaded, by the typeid() name of the test class registering it
+	struct notedTest_t final
+	{
+		const char *suite;
+		const char *test;
+		const char *tags;
+	};
+
+	// Collects the tests noted by the test libraries the calling thread loads into context, or drops them if
+	// context is nullptr. Loading a library that is already loaded notes nothing.
+	CRUNCHpp_API void notingContext(std::vector<notedTest_t> *context) noexcept;
+	// Lists the tests noted for the suite of library without constructing the suite, returning false if none
+	// were, as the suite's tests are then only known by constructing it
+	CRUNCHpp_API bool listNotedTests(const char *library, const char *suite, const std::vector<notedTest_t> &tests);
 } // namespace crunch
 
 #endif /*CORE__HXX*/
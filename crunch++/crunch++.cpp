@@ -5,7 +5,6 @@
 #include <dlfcn.h>
 #include <unistd.h>
 #include <csignal>
-#include <execinfo.h>
 #else
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -34,11 +33,30 @@ char *dlerror()
 #include <crtdbg.h>
 #endif
 #include <exception>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <cstdlib>
 #include <utility>
 #include <substrate/utility>
 #include "core.hxx"
 #include "logger.hxx"
+#include "workerPool.hxx"
+#include "isolation.hxx"
+#include "history.hxx"
+#include "timing.hxx"
+#include "backtrace.hxx"
+#include "shard.hxx"
+#include "filter.hxx"
+#include "libraryCache.hxx"
+#include "capture.hxx"
+#include "output.hxx"
+#include "reporter.hxx"
+#include "watch.hxx"
+#include "daemon.hxx"
+#include "manifest.hxx"
 #include "argsParser.hxx"
 #include "stringFuncs.hxx"
 #include "crunch++.h"
@@ -60,6 +78,25 @@ namespace crunch
 	constexpr auto args{substrate::make_array<arg_t>(
 	{
 		{"--log"_sv, 1, 1, 0},
+		{"--jobs"_sv, 1, 1, 0},
+		{"--isolate"_sv, 0, 0, 0},
+		{"--history"_sv, 1, 1, 0},
+		{"--timeout"_sv, 1, 1, 0},
+		{"--suite-timeout"_sv, 1, 1, 0},
+		{"--shard="_sv, 0, 0, ARG_INCOMPLETE},
+		{"--shard-libraries"_sv, 0, 0, 0},
+		{"--shard-timings"_sv, 1, 1, 0},
+		{"--filter"_sv, 1, 1, ARG_REPEATABLE},
+		{"--tag"_sv, 1, 1, ARG_REPEATABLE},
+		{"--max-failures"_sv, 1, 1, 0},
+		{"--skip-unchanged"_sv, 0, 0, 0},
+		{"--capture"_sv, 0, 0, 0},
+		{"--async-output"_sv, 0, 0, 0},
+		{"--reporter="_sv, 0, 0, ARG_INCOMPLETE},
+		{"--report-file"_sv, 1, 1, 0},
+		{"--watch"_sv, 0, 0, 0},
+		{"--daemon"_sv, 1, 1, 0},
+		{"--list"_sv, 0, 0, 0},
 		{"--help"_sv, 0, 0, 0},
 		{"-h"_sv, 0, 0, 0},
 		{"--version"_sv, 0, 0, 0},
@@ -114,14 +151,26 @@ namespace crunch
 #endif
 	}
 
-	void printStats()
+	void printStats(const testResults_t &runResults)
 	{
-		uint64_t total = passes + failures;
-		testPrintf("Total tests: %" PRIu64 ",  Failures: %" PRIu32 ",  Pass rate: ", total, failures);
+		const auto total{runResults.total()};
+		testPrintf("Total tests: %" PRIu64 ",  Failures: %" PRIu32 ",  Pass rate: ", total, runResults.failures.load());
 		if (total == 0)
 			testPrintf("--\n");
 		else
-			testPrintf("%0.2f%%\n", double(passes) / double(total) * 100.0);
+			testPrintf("%0.2f%%\n", double(runResults.passes) / double(total) * 100.0);
+		if (cachedLibraries)
+			testPrintf("Skipped %" PRIu32 " unchanged test libraries that passed last time\n", cachedLibraries.load());
+		printSlowest();
+	}
+
+	// Whether --filter or --tag were given yet selected no test at all, most likely from a mistyped pattern, so
+	// the run fails rather than passing having run nothing. One shard of a run, or a run whose libraries were
+	// all skipped as unchanged, may rightly have nothing to run.
+	bool filtersSelectedNothing(const testResults_t &runResults) noexcept
+	{
+		return (!nameFilters.empty() || !tagFilters.empty()) && !listingTests && shardCount == 1 &&
+			!cachedLibraries && runResults.total() == 0;
 	}
 
 	bool getTests()
@@ -138,18 +187,246 @@ namespace crunch
 		return !namedTests.empty();
 	}
 
-	bool tryRegistration(void *testSuite) try
+	bool getJobs()
+	{
+		const auto *const jobs{findArg(parsedArgs, "--jobs"_sv, nullptr)};
+		if (!jobs)
+			return true;
+		const auto &count{jobs->params[0]};
+		char *end{nullptr};
+		const auto value{std::strtoul(count.c_str(), &end, 10)};
+		if (count.empty() || *end || value > UINT32_MAX)
+		{
+			testPrintf("Fatal error: '%s' is not a valid number of jobs\n", count.c_str());
+			return false;
+		}
+		// --jobs 0 means "one per hardware thread"
+		testJobs = value ? uint32_t(value) : std::thread::hardware_concurrency();
+		if (!testJobs)
+			testJobs = 1;
+		return true;
+	}
+
+	bool getMaxFailures()
+	{
+		const auto *const limit{findArg(parsedArgs, "--max-failures"_sv, nullptr)};
+		if (!limit)
+			return true;
+		const auto &count{limit->params[0]};
+		char *end{nullptr};
+		const auto value{std::strtoul(count.c_str(), &end, 10)};
+		if (count.empty() || *end || !value || value > UINT32_MAX)
+		{
+			testPrintf("Fatal error: '%s' is not a valid number of failures\n", count.c_str());
+			return false;
+		}
+		maxFailures = uint32_t(value);
+		return true;
+	}
+
+	bool getTimeout(const internal::stringView &option, uint64_t &timeout)
+	{
+		const auto *const limit{findArg(parsedArgs, option, nullptr)};
+		if (!limit)
+			return true;
+		const auto &seconds{limit->params[0]};
+		char *end{nullptr};
+		const auto value{std::strtod(seconds.c_str(), &end)};
+		if (seconds.empty() || *end || !(value >= 0.0 && value < 1e9))
+		{
+			testPrintf("Fatal error: '%s' is not a valid number of seconds for %s\n", seconds.c_str(), option.data());
+			return false;
+		}
+		timeout = uint64_t(value * 1e9);
+		return true;
+	}
+
+	// Parses --shard=INDEX/COUNT, where INDEX counts from 1
+	bool getShard()
+	{
+		const auto *const shard{findArg(parsedArgs, "--shard="_sv, nullptr)};
+		if (!shard)
+			return true;
+		const auto spec{shard->value.substr("--shard="_sv.length())};
+		const std::string value{spec.data(), spec.length()};
+		char *end{nullptr};
+		const auto index{std::strtoul(value.c_str(), &end, 10)};
+		const auto valid{*end == '/' && end != value.c_str()};
+		const auto *const countBegin{end + 1};
+		const auto count{valid ? std::strtoul(countBegin, &end, 10) : 0};
+		if (!valid || end == countBegin || *end || !index || index > count || count > UINT32_MAX)
+		{
+			testPrintf("Fatal error: '%s' is not a valid shard, expected INDEX/COUNT with 1 <= INDEX <= COUNT\n",
+				value.c_str());
+			return false;
+		}
+		shardIndex = uint32_t(index - 1U);
+		shardCount = uint32_t(count);
+		shardLibraries = findArg(parsedArgs, "--shard-libraries"_sv, nullptr);
+		return true;
+	}
+
+	// Loads the --shard-timings file to balance the shards by. It must be there to be read, as a shard
+	// that went without while the others balanced by it would split the tests up differently to them
+	bool getShardTimings(std::unique_ptr<testHistory_t> &timings)
+	{
+		const auto *const timingsFile{findArg(parsedArgs, "--shard-timings"_sv, nullptr)};
+		if (!timingsFile)
+			return true;
+		const auto &fileName{timingsFile->params[0]};
+		auto *const file{fopen(fileName.c_str(), "rb")};
+		if (!file)
+		{
+			testPrintf("Fatal error: could not read the --shard-timings file %s\n", fileName.c_str());
+			return false;
+		}
+		fclose(file);
+		timings = makeUnique<testHistory_t>(fileName);
+		shardTimings = timings.get();
+		return true;
+	}
+
+	// When sharding by library, drop the libraries that belong to other shards
+	void selectLibraryShard()
+	{
+		if (shardCount < 2 || !shardLibraries)
+			return;
+		std::vector<const char *> libraries{};
+		libraries.reserve(numTests);
+		for (const auto *const library : namedTests)
+			libraries.push_back(library->value.data());
+		const auto shards{shardsForLibraries(libraries)};
+		parsedRefArgs_t selected{};
+		for (size_t i{0}; i < numTests; ++i)
+		{
+			if (shards[i] == shardIndex)
+				selected.push_back(namedTests[i]);
+		}
+		namedTests.swap(selected);
+		numTests = namedTests.size();
+	}
+
+	bool getTimeouts()
+		{ return getTimeout("--timeout"_sv, testTimeout) && getTimeout("--suite-timeout"_sv, suiteTimeout); }
+
+	// Collects the patterns given to --filter and --tag, which may each be given more than once
+	void getFilters()
+	{
+		for (const auto &parsedArg : parsedArgs)
+		{
+			if (parsedArg.matches("--filter"_sv))
+				nameFilters.emplace_back(parsedArg.params[0]);
+			else if (parsedArg.matches("--tag"_sv))
+				tagFilters.emplace_back(parsedArg.params[0]);
+		}
+	}
+
+	bool getSkipUnchanged()
+	{
+		if (!findArg(parsedArgs, "--skip-unchanged"_sv, nullptr))
+			return true;
+		if (!findArg(parsedArgs, "--history"_sv, nullptr))
+		{
+			testPrintf("Fatal error: --skip-unchanged needs a --history file to keep its results in\n");
+			return false;
+		}
+		if (!libraryCacheSupported)
+			testPrintf("Warning: --skip-unchanged is not supported on this platform, running every test library\n");
+		skipUnchanged = libraryCacheSupported;
+		return true;
+	}
+
+	void getCapture()
+	{
+		if (!findArg(parsedArgs, "--capture"_sv, nullptr))
+			return;
+		if (!startCapturing())
+			testPrintf("Warning: could not set up capturing test output, tests will write straight to the console\n");
+		else
+			captureTestOutput = true;
+	}
+
+	// The writer may flush our output at any time, so it must go to a stream of our own that tests
+	// can't redirect out from under us, as they may with stdout
+	bool getAsyncOutput()
+	{
+		if (!findArg(parsedArgs, "--async-output"_sv, nullptr))
+			return false;
+		if (startCapturing())
+			return true;
+		testPrintf("Warning: could not set up writing output in the background, writing it as tests start\n");
+		return false;
+	}
+
+	// Sets up the reporter named by --reporter=FORMAT to write to the --report-file given
+	bool getReporter(std::unique_ptr<reporter_t> &reporter)
+	{
+		const auto *const format{findArg(parsedArgs, "--reporter="_sv, nullptr)};
+		const auto *const fileName{findArg(parsedArgs, "--report-file"_sv, nullptr)};
+		if (!format && !fileName)
+			return true;
+		else if (!format || !fileName)
+		{
+			testPrintf("Fatal error: --reporter= and --report-file must be given together\n");
+			return false;
+		}
+		const auto name{format->value.substr("--reporter="_sv.length())};
+		const std::string value{name.data(), name.length()};
+		reporter = makeReporter(value, fileName->params[0]);
+		if (!reporter)
+		{
+			testPrintf("Fatal error: could not write a '%s' report to %s, the reporters are junit and json\n",
+				value.c_str(), fileName->params[0].c_str());
+			return false;
+		}
+		testReporter = reporter.get();
+		return true;
+	}
+
+	void getIsolation()
+	{
+		// Tests that overrun can only be stopped if they are run in worker processes, and as stdout and
+		// stderr are shared by the whole process, tests can only have their output captured in parallel there too
+		const auto capturingInParallel{captureTestOutput && testJobs > 1};
+		if (!findArg(parsedArgs, "--isolate"_sv, nullptr) && !testTimeout && !suiteTimeout && !capturingInParallel)
+			return;
+#ifndef _WIN32
+		isolateTests = true;
+#else
+		testPrintf("Warning: --isolate and timeouts are not supported on this platform, running tests in-process\n");
+		testTimeout = 0;
+		suiteTimeout = 0;
+		if (capturingInParallel)
+		{
+			testPrintf("Warning: output can't be captured from tests run in parallel on this platform\n");
+			captureTestOutput = false;
+		}
+#endif
+	}
+
+	bool tryRegistration(void *testSuite, std::vector<cxxTestClass> &suites) try
 	{
 		const auto registerTests = reinterpret_cast<registerFn>(dlsym(testSuite, "registerCXXTests")); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast) lgtm[cpp/reinterpret-cast]
 		if (registerTests)
-			registerTests();
-		else
+		{
+			registrationContext(&suites);
+			try
+				{ registerTests(); }
+			catch (...)
+			{
+				registrationContext(nullptr);
+				throw;
+			}
+			registrationContext(nullptr);
+		}
+		// The daemon keeps hold of every library it loads until it changes
+		else if (!residentLibraries)
 			dlclose(testSuite);
 		return registerTests;
 	}
 	catch (const std::bad_alloc &)
 	{
-		cxxTests.clear();
+		suites.clear();
 		red();
 		testPrintf("Failed to allocate memory while performing test registration");
 		newline();
@@ -176,76 +453,374 @@ namespace crunch
 		return {};
 	}
 
-	void runTests()
+	// Watches the directories of the test libraries for them being rebuilt, so they can be run again
+	bool getWatch(std::unique_ptr<libraryWatcher_t> &watcher)
 	{
-		testLog *logFile{};
-		const auto *const logging{findArg(parsedArgs, "--log"_sv, nullptr)};
-		if (logging)
+		if (!findArg(parsedArgs, "--watch"_sv, nullptr))
+			return true;
+		if (!watchSupported)
 		{
-			logFile = startLogging(logging->params[0].data());
-			loggingTests = true;
+			testPrintf("Warning: --watch is not supported on this platform, running the tests once\n");
+			return true;
+		}
+		watcher = makeUnique<libraryWatcher_t>();
+		for (size_t i{0}; watcher->valid() && i < numTests; ++i)
+		{
+			const auto &library{namedTests[i]->value};
+			const auto testLib{extForLibrary(library)};
+			// A library that doesn't exist yet is watched for under the name it would most likely be built as
+			const auto path{testLib ? std::string{testLib.get()} :
+				std::string{workingDir.get()} + '/' + library.data() + '.' + libExt[0].data()};
+			if (!watcher->watch(i, path))
+			{
+				testPrintf("Fatal error: could not watch %s for changes\n", path.c_str());
+				return false;
+			}
 		}
+		if (!watcher->valid())
+		{
+			testPrintf("Fatal error: could not set up watching the test libraries for changes\n");
+			return false;
+		}
+		watchingLibraries = true;
+		return true;
+	}
 
-		for (size_t i{0}; i < numTests; i++)
+	// When watching, unloads a test library once it has been run, so a rebuilt copy of it can be loaded in
+	// its place. The library's code backs the test classes registered from it, so those must go first.
+	// The daemon instead keeps the library loaded, to register its test classes afresh on the next request.
+	struct loadedLibrary_t final
+	{
+	private:
+		void *handle;
+		std::vector<cxxTestClass> &suites;
+		const char *path;
+
+	public:
+		loadedLibrary_t(void *const handle_, std::vector<cxxTestClass> &suites_, const char *const path_) noexcept :
+			handle{handle_}, suites{suites_}, path{path_} { }
+		loadedLibrary_t(const loadedLibrary_t &) = delete;
+		loadedLibrary_t(loadedLibrary_t &&) = delete;
+		loadedLibrary_t &operator =(const loadedLibrary_t &) = delete;
+		loadedLibrary_t &operator =(loadedLibrary_t &&) = delete;
+
+		~loadedLibrary_t() noexcept
 		{
-			auto testLib{extForLibrary(namedTests[i]->value)};
-			if (!testLib)
+			if (!watchingLibraries && !residentLibraries)
+				return;
+			suites.clear();
+			if (residentLibraries)
+				return;
+			dlclose(handle);
+#ifdef RTLD_NOLOAD
+			// Libraries with unique symbols, which inline and template statics can become, are never unloaded
+			auto *const resident{dlopen(path, RTLD_LAZY | RTLD_NOLOAD)};
+			if (resident)
 			{
+				dlclose(resident);
 				red();
-				testPrintf("Test library %s does not exist, skipping", namedTests[i]->value.data());
+				testPrintf("Test library %s can't be unloaded, so crunch++ must be restarted to pick up changes to it",
+					path);
 				newline();
-				continue;
 			}
-			auto *testSuite{dlopen(testLib.get(), RTLD_LAZY)};
-			if (!testSuite || !tryRegistration(testSuite))
+#endif
+		}
+	};
+
+	// Loads, registers and runs the test suites of one test library. The library's test
+	// classes are registered into their own context so other libraries may run alongside.
+	void runLibrary(const internal::stringView &library)
+	{
+		auto testLib{extForLibrary(library)};
+		if (!testLib)
+		{
+			red();
+			testPrintf("Test library %s does not exist, skipping", library.data());
+			newline();
+			return;
+		}
+		if (!filtersMayMatch(readManifest(testLib.get())))
+		{
+			magenta();
+			testPrintf("Test library %s has no tests the filters select, skipping", library.data());
+			newline();
+			return;
+		}
+		if (!listingTests && libraryUnchanged(library.data()))
+		{
+			magenta();
+			testPrintf("Test library %s is unchanged since it last passed, skipping", library.data());
+			newline();
+			++cachedLibraries;
+			return;
+		}
+		noteTestLibrary(testLib.get());
+		std::vector<cxxTestClass> suites{};
+		std::vector<notedTest_t> notedTests{};
+		notingContext(&notedTests);
+		auto *testSuite{residentLibraries ? residentLibrary(testLib.get()) : dlopen(testLib.get(), RTLD_LAZY)};
+		notingContext(nullptr);
+		if (!testSuite || !tryRegistration(testSuite, suites))
+		{
+			const auto *const error{testSuite ? nullptr : dlerror()};
+			if (error)
 			{
-				if (!testSuite)
-				{
-					red();
-					testPrintf("Could not open test library: %s", dlerror());
-					newline();
-				}
 				red();
-				testPrintf("Test library %s was not a valid library, skipping", namedTests[i]->value.data());
+				testPrintf("Could not open test library: %s", error);
 				newline();
-				continue;
 			}
+			red();
+			testPrintf("Test library %s was not a valid library, skipping", library.data());
+			newline();
+			return;
+		}
+		const loadedLibrary_t loadedLibrary{testSuite, suites, testLib.get()};
+		if (!listingTests)
+		{
 			magenta();
-			testPrintf("Running test suite %s...", namedTests[i]->value.data());
+			testPrintf("Running test suite %s...", library.data());
 			newline();
+		}
 
-			for (auto &test : cxxTests)
+		// Whether every test in the library gets run, so passing means the whole library passed
+		bool ranAll{nameFilters.empty() && tagFilters.empty() && (shardCount == 1 || shardLibraries)};
+		// Run the test classes with tests that failed last time first
+		if (testHistory)
+			std::stable_partition(suites.begin(), suites.end(), [&](const cxxTestClass &suite)
+				{ return testHistory->anyFailed(library.data(), suite.name()); });
+		for (auto &test : suites)
+		{
+			if (!listingTests)
 			{
 				magenta();
 				testPrintf("Running tests in class %s...", test.name());
 				newline();
+			}
+
+			// Test classes whose tests were noted as the library was loaded are listed without being constructed
+			if (listingTests && listNotedTests(library.data(), test.name(), notedTests))
+				continue;
+			// Test classes registered with a factory are only constructed here
+			try { test.suite()->registerTests(); }
+			catch (threadExit_t &)
+			{
+				ranAll = false;
+				continue;
+			}
+			catch (std::bad_alloc &)
+			{
+				red();
+				testPrintf("Failed to allocate memory while registering suite");
+				newline();
+				ranAll = false;
+				continue;
+			}
+
+			historyContext(library.data(), test.name());
+			try
+				{ test.suite()->test(); }
+			catch (...)
+			{
+				historyContext(nullptr, nullptr);
+				throw;
+			}
+			historyContext(nullptr, nullptr);
+		}
+		if (ranAll && !listingTests && !failureLimitReached())
+			recordLibrary(library.data(), testLib.get());
+	}
 
-				try { test.suite()->registerTests(); }
-				catch (threadExit_t &) { continue; }
-				catch (std::bad_alloc &)
+	void runLibrary(const size_t index)
+		{ runLibrary(namedTests[index]->value); }
+
+	struct libraryResult_t final
+	{
+		std::string output{};
+		std::exception_ptr error{};
+		bool complete{false};
+	};
+
+	// Returns the order in which to run the test libraries, starting with those that had failures
+	// last time, and then if asked, those that took longest, keeping to command line order otherwise.
+	// Without a history, the libraries whose manifests record the most tests are taken to take longest.
+	std::vector<size_t> libraryOrder(const bool longestFirst)
+	{
+		std::vector<size_t> order(numTests);
+		for (size_t i{0}; i < numTests; ++i)
+			order[i] = i;
+		if (!testHistory)
+		{
+			if (!longestFirst)
+				return order;
+			std::vector<size_t> testCount(numTests);
+			for (size_t i{0}; i < numTests; ++i)
+			{
+				const auto library{extForLibrary(namedTests[i]->value)};
+				testCount[i] = library ? readManifest(library.get()).tests.size() : 0;
+			}
+			std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b)
+				{ return testCount[a] > testCount[b]; });
+			return order;
+		}
+		std::vector<uint64_t> expected(numTests);
+		std::vector<bool> failed(numTests);
+		for (size_t i{0}; i < numTests; ++i)
+		{
+			const auto *const library{namedTests[i]->value.data()};
+			expected[i] = longestFirst ? testHistory->libraryDuration(library) : 0;
+			failed[i] = testHistory->anyFailed(library);
+		}
+		std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b)
+			{ return failed[a] != failed[b] ? bool(failed[a]) : expected[a] > expected[b]; });
+		return order;
+	}
+
+	// Runs up to jobs test libraries at once. Each library's output is captured by the thread
+	// running it and replayed here in command line order, and an abort in one library stops
+	// any that have yet to start before being passed on.
+	void runLibrariesParallel(const size_t jobs)
+	{
+		std::vector<libraryResult_t> results(numTests);
+		const auto order{libraryOrder(true)};
+		std::mutex resultsLock{};
+		std::condition_variable resultReady{};
+		std::atomic<size_t> nextLibrary{0};
+		std::atomic<bool> aborting{false};
+
+		const auto runner = [&]()
+		{
+			for (auto next{nextLibrary++}; next < numTests; next = nextLibrary++)
+			{
+				const auto index{order[next]};
+				auto &result{results[index]};
+				if (!aborting)
 				{
-					red();
-					testPrintf("Failed to allocate memory while registering suite");
-					newline();
-					continue;
+					captureOutput(&result.output);
+					try
+						{ runLibrary(index); }
+					catch (...)
+						{ result.error = std::current_exception(); }
+					captureOutput(nullptr);
 				}
+				std::lock_guard<std::mutex> lock{resultsLock};
+				result.complete = true;
+				resultReady.notify_all();
+			}
+		};
 
-				try
-					{ test.suite()->test(); }
-				catch (threadExit_t &)
+#ifdef _WIN32
+		// Console colouring is applied out-of-band on Windows, so can't be replayed from a buffer
+		const auto wasTTY{isTTY};
+		isTTY = false;
+#endif
+		std::vector<std::thread> runners{};
+		const auto finish = [&]()
+		{
+			aborting = true;
+			for (auto &runnerThread : runners)
+				runnerThread.join();
+#ifdef _WIN32
+			isTTY = wasTTY;
+#endif
+		};
+
+		size_t reported{0};
+		try
+		{
+			runners.reserve(jobs);
+			for (size_t i{0}; i < jobs; ++i)
+				runners.emplace_back(runner);
+
+			for (; reported < numTests; ++reported)
+			{
+				auto &result{results[reported]};
+				{
+					std::unique_lock<std::mutex> lock{resultsLock};
+					resultReady.wait(lock, [&]() { return result.complete; });
+				}
+				if (!result.output.empty())
 				{
-					cxxTests.clear();
-					printStats();
-					if (logging != nullptr)
-						stopLogging(logFile);
-					throw;
+					testPrintf("%s", result.output.c_str());
+					syncOutput();
 				}
+				if (result.error)
+					std::rethrow_exception(result.error);
+			}
+		}
+		catch (...)
+		{
+			finish();
+			// Libraries that were already running still ran to completion and are in the totals, so report them too
+			while (++reported < numTests)
+			{
+				if (!results[reported].output.empty())
+					testPrintf("%s", results[reported].output.c_str());
 			}
-			cxxTests.clear();
-			cxxTests.shrink_to_fit();
+			throw;
+		}
+		finish();
+	}
+
+	// Starts the counts and statistics of the run over, for running rebuilt test libraries again
+	void resetRun()
+	{
+		results.reset();
+		cachedLibraries = 0;
+		forgetSlowest();
+		forgetFileHashes();
+	}
+
+	// Runs the test libraries given by index one after the other, or if none are given, all of them
+	void runTests(const std::vector<size_t> *const libraries = nullptr)
+	{
+		testLog *logFile{};
+		const auto *const logging{findArg(parsedArgs, "--log"_sv, nullptr)};
+		if (logging)
+		{
+			logFile = startLogging(logging->params[0].data());
+			loggingTests = true;
 		}
 
-		printStats();
+		try
+		{
+			// Worker processes are forked from the thread running a library, so when isolating
+			// tests, only one library may be in flight at a time
+			const auto libraryJobs{isolateTests ? 1U : std::min<size_t>(testJobs, numTests)};
+			if (libraries)
+			{
+				for (const auto index : *libraries)
+					runLibrary(index);
+			}
+			else if (libraryJobs > 1)
+				runLibrariesParallel(libraryJobs);
+			else
+			{
+				for (const auto index : libraryOrder(false))
+					runLibrary(index);
+			}
+		}
+		catch (threadExit_t &)
+		{
+			if (failureLimitReached())
+				testPrintf("Stopping the run as it has reached --max-failures %" PRIu32 "\n", maxFailures);
+			printStats(results);
+			if (testReporter)
+				testReporter->finish(results);
+			if (logging != nullptr)
+				stopLogging(logFile);
+			throw;
+		}
+
+		if (!listingTests)
+			printStats(results);
+		if (filtersSelectedNothing(results))
+		{
+			red();
+			testPrintf("Error: the --filter and --tag patterns given select none of the tests");
+			newline();
+		}
+		if (testReporter)
+			testReporter->finish(results);
 		if (logging != nullptr)
 			stopLogging(logFile);
 	}
@@ -368,6 +943,12 @@ namespace crunch
 
 	void trapHandler(const int, siginfo_t *const info, void *const context)
 	{
+		// Whatever the test wrote before crashing may well say why, so make sure it isn't lost,
+		// getting what we'd buffered out first so it still comes ahead of what the test wrote
+		flushOutput();
+		if (testReporter)
+			testReporter->flush();
+		abandonCapture();
 		const auto *const ctx{static_cast<ucontext_t *>(context)};
 		const auto &mctx{ctx->uc_mcontext};
 
@@ -443,19 +1024,7 @@ REGISTERS:
 		);
 #endif
 
-		fprintf(stderr, "---- BEGIN STACK TRACE ----\n");
-		std::array<void *, 256> calls{};
-		backtrace(calls.data(), calls.size());
-		auto **symbols = backtrace_symbols(calls.data(), calls.size());
-		for (size_t i{}; i < calls.size() && calls[i]; ++i)
-		{
-			const auto demangledSymbol{substrate::decode_typename(symbols[i])};
-			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-			fprintf(stderr, "\t[%#018" PRIxPTR "]\t%s\n", reinterpret_cast<uintptr_t>(calls[i]), demangledSymbol.c_str());
-		}
-		// NOLINTNEXTLINE(cppcoreguidelines-no-malloc,cppcoreguidelines-owning-memory)
-		free(symbols);
-		fprintf(stderr, "----- END STACK TRACE -----\n");
+		fputs(formatBacktrace().c_str(), stderr);
 
 		if (info->si_signo != SIGABRT)
 		{
@@ -476,6 +1045,124 @@ REGISTERS:
 	};
 #endif
 
+#ifndef _WIN32
+	// The console was resized, so the width getColumns() cached is out of date
+	static void resizeHandler(const int) noexcept
+		{ refreshColumns(); }
+#endif
+
+	// Runs the test libraries again each time any are rebuilt, saving the history and writing a fresh
+	// report after each run. Only returns if the libraries can no longer be watched.
+	void watchTests(const libraryWatcher_t &watcher, std::unique_ptr<reporter_t> &reporter,
+		const constParsedArg_t historyFile)
+	{
+		while (true)
+		{
+			if (testHistory && !testHistory->save())
+				testPrintf("Warning: could not save test history to %s\n", historyFile->params[0].c_str());
+			magenta();
+			testPrintf("Watching for the test libraries to be rebuilt...");
+			newline();
+			flushOutput();
+			const auto libraries{watcher.wait()};
+			if (libraries.empty())
+			{
+				testPrintf("Fatal error: lost track of the test libraries being watched\n");
+				return;
+			}
+			resetRun();
+			if (reporter && !getReporter(reporter))
+				return;
+			try { runTests(&libraries); }
+			catch (threadExit_t &) { } // NOLINT(bugprone-empty-catch)
+		}
+	}
+
+	// Runs the tests a client of the daemon asked for, streaming each test's result back to it as JSON
+	void serveRequest(const testRequest_t &request, FILE *const client)
+	{
+		if (!extForLibrary(request.library))
+		{
+			fprintf(client, "{\"error\": \"Test library %s does not exist\"}\n", jsonEscape(request.library).c_str());
+			fclose(client); // NOLINT(cppcoreguidelines-owning-memory)
+			return;
+		}
+		resetRun();
+		// The patterns asked for add to those the daemon was started with
+		const auto filters{nameFilters.size()};
+		nameFilters.insert(nameFilters.end(), request.patterns.begin(), request.patterns.end());
+		const auto reporter{makeReporter("json", client)};
+		testReporter = reporter.get();
+		try { runLibrary(request.library); }
+		catch (threadExit_t &) { } // NOLINT(bugprone-empty-catch)
+		printStats(results);
+		reporter->finish(results);
+		testReporter = nullptr;
+		nameFilters.resize(filters);
+	}
+
+	// Keeps the test libraries loaded and runs their tests as clients ask, until one asks the daemon to quit
+	int32_t runDaemon(const std::string &socketPath, const constParsedArg_t historyFile)
+	{
+		testDaemon_t daemon{socketPath};
+		if (!daemon.valid())
+		{
+			testPrintf("Fatal error: could not listen for requests on %s\n", socketPath.c_str());
+			return 2;
+		}
+		residentLibraries = true;
+		// Load the libraries named on the command line up front, so even the first request for them is quick
+		for (size_t i{0}; i < numTests; ++i)
+		{
+			const auto testLib{extForLibrary(namedTests[i]->value)};
+			if (testLib)
+				residentLibrary(testLib.get());
+		}
+		magenta();
+		testPrintf("Listening for requests to run tests on %s", socketPath.c_str());
+		newline();
+		flushOutput();
+		while (daemon.valid())
+		{
+			testRequest_t request{};
+			auto *const client{daemon.accept(request)};
+			if (!client)
+				continue;
+			else if (request.quit)
+			{
+				fclose(client); // NOLINT(cppcoreguidelines-owning-memory)
+				return 0;
+			}
+			serveRequest(request, client);
+			if (testHistory && !testHistory->save())
+				testPrintf("Warning: could not save test history to %s\n", historyFile->params[0].c_str());
+			flushOutput();
+		}
+		testPrintf("Fatal error: stopped being able to take requests on %s\n", socketPath.c_str());
+		return 2;
+	}
+
+	// Checks --daemon isn't combined with options that only make sense for a single run from the command line
+	bool getDaemon()
+	{
+		if (!findArg(parsedArgs, "--daemon"_sv, nullptr))
+			return true;
+		if (!daemonSupported)
+		{
+			testPrintf("Fatal error: --daemon is not supported on this platform\n");
+			return false;
+		}
+		for (const auto &option : {"--watch"_sv, "--reporter="_sv, "--report-file"_sv, "--log"_sv, "--list"_sv})
+		{
+			if (findArg(parsedArgs, option, nullptr))
+			{
+				testPrintf("Fatal error: --daemon can't be combined with %s\n", option.data());
+				return false;
+			}
+		}
+		return true;
+	}
+
 	bool handleVersionOrHelp()
 	{
 		constParsedArg_t version{findArg(parsedArgs, "--version"_sv, nullptr)};
@@ -509,14 +1196,52 @@ REGISTERS:
 		parsedArgs = parseArguments(argc, argv);
 		if (!parsedArgs.empty() && handleVersionOrHelp())
 			return 0;
-		else if (parsedArgs.empty() || !getTests())
+		const auto *const daemonSocket{findArg(parsedArgs, "--daemon"_sv, nullptr)};
+		// The daemon gets told which tests to run by its clients, so may be started without any
+		if (parsedArgs.empty() || (!getTests() && !daemonSocket))
 		{
 			testPrintf("Fatal error: There are no tests to run given on the command line!\n");
 			return 2;
 		}
+		else if (!getJobs() || !getMaxFailures() || !getTimeouts() || !getShard() || !getSkipUnchanged() ||
+			!getDaemon())
+			return 2;
+		getCapture();
+		getIsolation();
+		getFilters();
+		listingTests = findArg(parsedArgs, "--list"_sv, nullptr);
+		std::unique_ptr<reporter_t> reporter{};
+		if (!getReporter(reporter))
+			return 2;
+		std::unique_ptr<testHistory_t> history{};
+		const auto *const historyFile{findArg(parsedArgs, "--history"_sv, nullptr)};
+		if (historyFile)
+		{
+			history = makeUnique<testHistory_t>(historyFile->params[0]);
+			testHistory = history.get();
+		}
+		std::unique_ptr<testHistory_t> timings{};
+		if (!getShardTimings(timings))
+			return 2;
+		selectLibraryShard();
+		// Save the timings we gathered however the run ends
+		const auto saveHistory = [&]()
+		{
+			testHistory = nullptr;
+			if (history && !history->save())
+				testPrintf("Warning: could not save test history to %s\n", historyFile->params[0].c_str());
+		};
 		workingDir.reset(getcwd(nullptr, 0));
+		std::unique_ptr<libraryWatcher_t> watcher{};
+		if (!getWatch(watcher))
+			return 2;
 #ifndef _WIN32
 		isTTY = isatty(STDOUT_FILENO);
+		struct sigaction resize{};
+		resize.sa_handler = resizeHandler;
+		resize.sa_flags = SA_RESTART;
+		sigemptyset(&resize.sa_mask);
+		sigaction(SIGWINCH, &resize, nullptr);
 #if defined(__x86_64__)
 		sigaction(SIGABRT, &trapSignal, nullptr);
 		sigaction(SIGSEGV, &trapSignal, nullptr);
@@ -533,10 +1258,39 @@ REGISTERS:
 		}
 		isTTY = bool(isatty(fileno(stdout)));
 #endif
+		// The runner threads for the tests live for the whole run rather than being spawned per test
+		workerPool_t workers{testJobs};
+		testWorkers = &workers;
+		std::unique_ptr<outputWriter_t> outputWriter{};
+		if (getAsyncOutput())
+			outputWriter = makeUnique<outputWriter_t>();
+		testOutputWriter = outputWriter.get();
+		if (daemonSocket)
+		{
+			const auto result{runDaemon(daemonSocket->params[0], historyFile)};
+			testWorkers = nullptr;
+			testOutputWriter = nullptr;
+			saveHistory();
+			return result;
+		}
 		try { runTests(); }
 		catch (threadExit_t &val)
-			{ return val; }
-		return failures ? 1 : 0;
+		{
+			if (watcher)
+				watchTests(*watcher, reporter, historyFile);
+			testWorkers = nullptr;
+			testOutputWriter = nullptr;
+			testReporter = nullptr;
+			saveHistory();
+			return watcher ? 2 : int32_t{val};
+		}
+		if (watcher)
+			watchTests(*watcher, reporter, historyFile);
+		testWorkers = nullptr;
+		testOutputWriter = nullptr;
+		testReporter = nullptr;
+		saveHistory();
+		return watcher ? 2 : results.failures || filtersSelectedNothing(results) ? 1 : 0;
 	}
 	catch (const std::out_of_range &error)
 	{
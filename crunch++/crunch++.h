@@ -8,9 +8,12 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <array>
 #include <thread>
 #include <vector>
 #include <type_traits>
+#include <utility>
 #include <typeinfo>
 #include <functional>
 #include <memory>
@@ -30,6 +33,8 @@
 #	define CRUNCH_API extern "C" CRUNCH_VIS
 #	define CRUNCHpp_EXPORT extern "C" __declspec(dllexport)
 #	define CRUNCH_MAYBE_VIS
+#	define CRUNCH_TEMPLATE_VIS
+#	define CRUNCH_HIDDEN
 #else
 #	if __GNUC__ >= 4 || defined(__APPLE__)
 #		define CRUNCH_VIS __attribute__ ((visibility("default")))
@@ -39,6 +44,8 @@
 #	define CRUNCH_API	extern "C" CRUNCH_VIS
 #	define CRUNCHpp_EXPORT		CRUNCH_API
 #	define CRUNCH_MAYBE_VIS	CRUNCH_VIS
+#	define CRUNCH_TEMPLATE_VIS	CRUNCH_VIS
+#	define CRUNCH_HIDDEN	__attribute__ ((visibility("hidden")))
 #endif
 #define CRUNCHpp_API	extern CRUNCH_VIS
 
@@ -70,18 +77,60 @@
 #	define CRUNCH_NO_DISCARD(x) x
 #endif
 
+#if defined(__GNUC__)
+#	define CRUNCH_LIKELY(x) __builtin_expect(!!(x), 1)
+#	define CRUNCH_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#	define CRUNCH_COLD __attribute__((cold))
+#else
+#	define CRUNCH_LIKELY(x) (x)
+#	define CRUNCH_UNLIKELY(x) (x)
+#	define CRUNCH_COLD
+#endif
+
+#if defined(__has_builtin)
+#	define CRUNCH_HAS_BUILTIN(builtin) __has_builtin(builtin)
+#else
+#	define CRUNCH_HAS_BUILTIN(builtin) 0
+#endif
+
+// Where a function was called from, as the defaults of its last parameters
+#if CRUNCH_HAS_BUILTIN(__builtin_FILE) || (defined(__GNUC__) && !defined(__clang__)) || \
+	(defined(_MSC_VER) && _MSC_VER >= 1926)
+#	define CRUNCH_CALLER_FILE __builtin_FILE()
+#	define CRUNCH_CALLER_LINE uint32_t(__builtin_LINE())
+#else
+#	define CRUNCH_CALLER_FILE nullptr
+#	define CRUNCH_CALLER_LINE 0U
+#endif
+
 #ifndef __APPLE__
 #define CRUNCHpp_MAYBE_NOEXCEPT(x) x noexcept
 #else
 #define CRUNCHpp_MAYBE_NOEXCEPT(x) x
 #endif
 
+class testsuite;
+
 namespace crunch
 {
 	namespace internal
 	{
 		struct cxxTest;
 
+		// One entry in a test class's table of tests, as built by CRUNCHpp_TEST_TABLE(), which the test is
+		// run straight from, through the function of runTableTest() for it
+		struct testEntry_t final
+		{
+			const char *name;
+			const char *tags;
+			void (*run)(testsuite &suite);
+		};
+
+		// Runs the test of a table entry on the suite it was registered by, calling it directly. These are
+		// exported so the runner can read which tests a library's tables hold from its dynamic symbol table.
+		template<typename suite_t, void (suite_t::*test)()> CRUNCH_TEMPLATE_VIS void runTableTest(testsuite &suite)
+			{ (static_cast<suite_t &>(suite).*test)(); }
+
 		template<typename T> struct isBoolean : std::false_type { };
 		template<> struct isBoolean<bool> : std::true_type { };
 
@@ -207,6 +256,91 @@ namespace crunch
 			{ return lhs.compare(rhs) == 0; }
 	} // namespace internal
 
+	// Specialise with a static print() that returns a std::string describing a value, to let
+	// assertEqual() and assertNotEqual() take values of a type of your own that has operator ==
+	template<typename T> struct printable_t;
+
+	namespace internal
+	{
+		template<typename T, typename = void> struct isPrintable : std::false_type { };
+		template<typename T> struct isPrintable<T, decltype(void(printable_t<T>::print(std::declval<const T &>())))> :
+			std::integral_constant<bool, !std::is_arithmetic<T>::value && !std::is_enum<T>::value &&
+				!std::is_pointer<T>::value> { };
+
+		// How close two doubles must be for assertEqual() to take them as equal
+		constexpr double doubleDelta{0.0000001};
+		constexpr inline bool withinDelta(const double result, const double expected) noexcept
+			{ return result >= expected - doubleDelta && result <= expected + doubleDelta; }
+
+		// The failure paths of the inline assertions, which report the failure and end the test
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void booleanFailure(bool value);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void equalFailure(int64_t result, int64_t expected);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void equalFailure(uint64_t result, uint64_t expected);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void equalFailure(double result, double expected);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void equalFailure(const void *result, const void *expected);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void printedEqualFailure(const std::string &result, const std::string &expected);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void notEqualFailure(int64_t result);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void notEqualFailure(uint64_t result);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void notEqualFailure(double result);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void notEqualFailure(const void *result);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void printedNotEqualFailure(const std::string &result);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void nullFailure(const void *result);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void notNullFailure();
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void greaterThanFailure(long result, long expected);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void lessThanFailure(long result, long expected);
+
+		// Types whose values are equal exactly when their bytes are, so ranges of them can be compared as memory
+		template<typename T> struct isBitwiseComparable : std::integral_constant<bool,
+			std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value> { };
+
+		// How the elements of a range are shown when assertRangeEqual() fails
+		enum class elementKind_t : uint8_t { signedInteger, unsignedInteger, pointer };
+		template<typename T, typename = void> struct isSignedElement : std::is_signed<T> { };
+		template<typename T> struct isSignedElement<T, enableIf<std::is_enum<T>::value>> :
+			std::is_signed<typename std::underlying_type<T>::type> { };
+		template<typename T> constexpr elementKind_t elementKind() noexcept
+		{
+			return std::is_pointer<T>::value ? elementKind_t::pointer :
+				isSignedElement<T>::value ? elementKind_t::signedInteger : elementKind_t::unsignedInteger;
+		}
+
+		// Returns the offset of the first byte that differs between two blocks of memory, or length if none do
+		CRUNCH_VIS std::size_t firstMismatch(const void *result, const void *expected, std::size_t length) noexcept;
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void rangeFailure(const void *result, const void *expected,
+			std::size_t count, std::size_t index, std::size_t elementSize, elementKind_t kind);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void rangeLengthFailure(std::size_t resultCount, std::size_t expectedCount);
+
+		// Count how many elements of two arrays are further apart than assertUlpEqual() or assertNear() allow
+		CRUNCH_VIS std::size_t countUlpFailures(const float *result, const float *expected, std::size_t count,
+			uint64_t maxUlps) noexcept;
+		CRUNCH_VIS std::size_t countUlpFailures(const double *result, const double *expected, std::size_t count,
+			uint64_t maxUlps) noexcept;
+		CRUNCH_VIS std::size_t countToleranceFailures(const float *result, const float *expected, std::size_t count,
+			double relative, double absolute) noexcept;
+		CRUNCH_VIS std::size_t countToleranceFailures(const double *result, const double *expected, std::size_t count,
+			double relative, double absolute) noexcept;
+		// Report the worst element out of tolerance and how the errors are spread
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void ulpFailure(const float *result, const float *expected,
+			std::size_t count, uint64_t maxUlps);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void ulpFailure(const double *result, const double *expected,
+			std::size_t count, uint64_t maxUlps);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void toleranceFailure(const float *result, const float *expected,
+			std::size_t count, double relative, double absolute);
+		[[noreturn]] CRUNCH_VIS CRUNCH_COLD void toleranceFailure(const double *result, const double *expected,
+			std::size_t count, double relative, double absolute);
+
+		// Records the failure of an expectation at file and line, which check(context) describes by running
+		// the failure path of the assertion the expectation is for, and lets the test carry on
+		CRUNCH_VIS CRUNCH_COLD void expectationFailure(const char *file, uint32_t line,
+			void (*check)(const void *context), const void *context);
+		template<typename check_t> void expectationFailure(const char *const file, const uint32_t line,
+			const check_t &check)
+		{
+			expectationFailure(file, line, [](const void *const context)
+				{ (*static_cast<const check_t *>(context))(); }, &check);
+		}
+	} // namespace internal
+
 	inline namespace literals
 	{
 		constexpr inline crunch::internal::stringView operator ""_sv(const char *const str,
@@ -214,6 +348,22 @@ namespace crunch
 	}
 } // namespace crunch
 
+// Test libraries built for ELF platforms carry a manifest of the tests ('T' records) they register in their
+// crunch_manifest section, one NUL terminated record after another, so the runner can see what they hold
+// without loading them. The test classes are read from the crunch::internal::makeTestClass<>() instantiations
+// exported by the library instead, as those name each class just as the runner does when it's loaded, and
+// the tests of CRUNCHpp_TEST_TABLE() tables from the crunch::internal::runTableTest<>() instantiations they
+// run through. Calling registerTest() directly registers tests not named in either, so adds a 'U' record to
+// say the manifest doesn't name all the tests. The records are assembled in with the function registering
+// them, so may be repeated if it's inlined or emitted by more than one object.
+#if defined(__ELF__) && defined(__GNUC__)
+#define CRUNCHpp_MANIFEST
+#define CRUNCHpp_MANIFEST_RECORD(kind, text) \
+	__asm__(".pushsection crunch_manifest, \"a\"\n\t.asciz \"" kind text "\"\n\t.popsection");
+#else
+#define CRUNCHpp_MANIFEST_RECORD(kind, text)
+#endif
+
 class CRUNCH_MAYBE_VIS testsuite
 {
 private:
@@ -225,28 +375,115 @@ private:
 	std::vector<crunch::internal::cxxTest> tests;
 
 protected:
+#ifdef CRUNCHpp_MANIFEST
+	// Tests registered by calling these directly aren't named in the test library's manifest, so these
+	// mark it as not naming them all, or the runner could skip the library thinking it didn't hold them
+	bool registerTest(std::function<void ()> &&func, const char *const name)
+	{
+		CRUNCHpp_MANIFEST_RECORD("U", "")
+		return registerMacroTest(std::move(func), name, nullptr);
+	}
+	// Registers a test with comma separated tags that --tag can select it by
+	bool registerTest(std::function<void ()> &&func, const char *const name, const char *const tags)
+	{
+		CRUNCHpp_MANIFEST_RECORD("U", "")
+		return registerMacroTest(std::move(func), name, tags);
+	}
+#else
 	CRUNCH_VIS bool registerTest(std::function<void ()> &&func, const char *const name);
+	// Registers a test with comma separated tags that --tag can select it by
+	CRUNCH_VIS bool registerTest(std::function<void ()> &&func, const char *const name, const char *const tags);
+#endif
+	// Registers a test for the CRUNCHpp_TEST() family of macros, which take care of the manifest themselves,
+	// with the comma separated tags --tag can select it by, or nullptr for none
+	CRUNCH_VIS bool registerMacroTest(std::function<void ()> &&func, const char *name, const char *tags);
+	// Makes room for count more tests to be registered without the test list growing as they are
+	CRUNCH_VIS bool reserveTests(std::size_t count);
+
+	// Registers every test in a table built by CRUNCHpp_TEST_TABLE(), which must outlive the suite
+	CRUNCH_VIS bool registerTestTable(const crunch::internal::testEntry_t *table, std::size_t count);
+	// Override the --timeout and --suite-timeout limits, in seconds, for this suite. 0 removes
+	// the limit. Tests are run in worker processes so those that overrun can be stopped.
+	CRUNCH_VIS void setTestTimeout(double seconds);
+	CRUNCH_VIS void setSuiteTimeout(double seconds);
 
 public:
 	CRUNCH_VIS void fail(const char *const reason);
 	CRUNCH_VIS void skip(const char *const reason);
 
-	CRUNCH_VIS void assertTrue(const bool value);
-	CRUNCH_VIS void assertFalse(const bool value);
-
-	CRUNCH_VIS void assertEqual(const int8_t result, const int8_t expected);
-	CRUNCH_VIS void assertEqual(const uint8_t result, const uint8_t expected);
-	CRUNCH_VIS void assertEqual(const int16_t result, const int16_t expected);
-	CRUNCH_VIS void assertEqual(const uint16_t result, const uint16_t expected);
-	CRUNCH_VIS void assertEqual(const int32_t result, const int32_t expected);
-	CRUNCH_VIS void assertEqual(const uint32_t result, const uint32_t expected);
-	CRUNCH_VIS void assertEqual(const int64_t result, const int64_t expected);
-	CRUNCH_VIS void assertEqual(const uint64_t result, const uint64_t expected);
+	// These assertions are inline so that passing one costs only its comparison. Failing ones
+	// are reported by the out of line functions in crunch::internal.
+	void assertTrue(const bool value)
+		{ if (CRUNCH_UNLIKELY(!value)) crunch::internal::booleanFailure(value); }
+	void assertFalse(const bool value)
+		{ if (CRUNCH_UNLIKELY(value)) crunch::internal::booleanFailure(value); }
+
+	void assertEqual(const int8_t result, const int8_t expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(int64_t{result}, int64_t{expected}); }
+	void assertEqual(const uint8_t result, const uint8_t expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(uint64_t{result}, uint64_t{expected}); }
+	void assertEqual(const int16_t result, const int16_t expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(int64_t{result}, int64_t{expected}); }
+	void assertEqual(const uint16_t result, const uint16_t expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(uint64_t{result}, uint64_t{expected}); }
+	void assertEqual(const int32_t result, const int32_t expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(int64_t{result}, int64_t{expected}); }
+	void assertEqual(const uint32_t result, const uint32_t expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(uint64_t{result}, uint64_t{expected}); }
+	void assertEqual(const int64_t result, const int64_t expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(result, expected); }
+	void assertEqual(const uint64_t result, const uint64_t expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(result, expected); }
+#if defined(__APPLE__)
+	void assertEqual(const std::size_t result, const std::size_t expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(uint64_t{result}, uint64_t{expected}); }
+#endif
+	void assertEqual(void *result, void *expected)
+		{ if (CRUNCH_UNLIKELY(result != expected)) crunch::internal::equalFailure(result, expected); }
+	void assertEqual(double result, double expected)
+	{
+		if (CRUNCH_UNLIKELY(!crunch::internal::withinDelta(result, expected)))
+			crunch::internal::equalFailure(result, expected);
+	}
+
+	void assertNotEqual(const int8_t result, const int8_t expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(int64_t{result}); }
+	void assertNotEqual(const uint8_t result, const uint8_t expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(uint64_t{result}); }
+	void assertNotEqual(const int16_t result, const int16_t expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(int64_t{result}); }
+	void assertNotEqual(const uint16_t result, const uint16_t expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(uint64_t{result}); }
+	void assertNotEqual(const int32_t result, const int32_t expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(int64_t{result}); }
+	void assertNotEqual(const uint32_t result, const uint32_t expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(uint64_t{result}); }
+	void assertNotEqual(const int64_t result, const int64_t expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(result); }
+	void assertNotEqual(const uint64_t result, const uint64_t expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(result); }
 #if defined(__APPLE__)
-	CRUNCH_VIS void assertEqual(const std::size_t result, const std::size_t expected);
+	void assertNotEqual(const std::size_t result, const std::size_t expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(uint64_t{result}); }
 #endif
-	CRUNCH_VIS void assertEqual(void *result, void *expected);
-	CRUNCH_VIS void assertEqual(double result, double expected);
+	void assertNotEqual(void *result, void *expected)
+		{ if (CRUNCH_UNLIKELY(result == expected)) crunch::internal::notEqualFailure(result); }
+	void assertNotEqual(double result, double expected)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::withinDelta(result, expected)))
+			crunch::internal::notEqualFailure(result);
+	}
+
+	void assertNull(const void *const result)
+		{ if (CRUNCH_UNLIKELY(result != nullptr)) crunch::internal::nullFailure(result); }
+	void assertNotNull(const void *const result)
+		{ if (CRUNCH_UNLIKELY(result == nullptr)) crunch::internal::notNullFailure(); }
+
+	void assertGreaterThan(const long result, const long expected)
+		{ if (CRUNCH_UNLIKELY(result <= expected)) crunch::internal::greaterThanFailure(result, expected); }
+	void assertLessThan(const long result, const long expected)
+		{ if (CRUNCH_UNLIKELY(result >= expected)) crunch::internal::lessThanFailure(result, expected); }
+
 	CRUNCH_VIS void assertEqual(const char *const result, const char *const expected);
 	CRUNCH_VIS void assertEqual(const void *const result, const void *const expected, const size_t expectedLength);
 
@@ -260,6 +497,15 @@ public:
 		assertEqual(U(a), U(b));
 	}
 
+	// Compares values of any other type with operator ==, describing them with crunch::printable_t<> on failure
+	template<typename T, typename = enableIf<crunch::internal::isPrintable<T>::value>>
+		void assertEqual(const T &result, const T &expected)
+	{
+		if (CRUNCH_UNLIKELY(!(result == expected)))
+			crunch::internal::printedEqualFailure(crunch::printable_t<T>::print(result),
+				crunch::printable_t<T>::print(expected));
+	}
+
 	void assertEqual(const std::string &result, const std::string &expected)
 		{ assertEqual(stringView{result.c_str(), result.length()}, stringView{expected.c_str(), expected.length()}); }
 #if __cplusplus >= 201703L
@@ -267,19 +513,6 @@ public:
 		{ assertEqual(stringView{result.data(), result.length()}, stringView{expected.data(), expected.length()}); }
 #endif
 
-	CRUNCH_VIS void assertNotEqual(const int8_t result, const int8_t expected);
-	CRUNCH_VIS void assertNotEqual(const uint8_t result, const uint8_t expected);
-	CRUNCH_VIS void assertNotEqual(const int16_t result, const int16_t expected);
-	CRUNCH_VIS void assertNotEqual(const uint16_t result, const uint16_t expected);
-	CRUNCH_VIS void assertNotEqual(const int32_t result, const int32_t expected);
-	CRUNCH_VIS void assertNotEqual(const uint32_t result, const uint32_t expected);
-	CRUNCH_VIS void assertNotEqual(const int64_t result, const int64_t expected);
-	CRUNCH_VIS void assertNotEqual(const uint64_t result, const uint64_t expected);
-#if defined(__APPLE__)
-	CRUNCH_VIS void assertNotEqual(const std::size_t result, const std::size_t expected);
-#endif
-	CRUNCH_VIS void assertNotEqual(void *result, void *expected);
-	CRUNCH_VIS void assertNotEqual(double result, double expected);
 	CRUNCH_VIS void assertNotEqual(const char *const result, const char *const expected);
 	CRUNCH_VIS void assertNotEqual(const void *const result, const void *const expected, const size_t expectedLength);
 
@@ -293,6 +526,13 @@ public:
 		assertNotEqual(U(a), U(b));
 	}
 
+	template<typename T, typename = enableIf<crunch::internal::isPrintable<T>::value>>
+		void assertNotEqual(const T &result, const T &expected)
+	{
+		if (CRUNCH_UNLIKELY(result == expected))
+			crunch::internal::printedNotEqualFailure(crunch::printable_t<T>::print(result));
+	}
+
 	void assertNotEqual(const std::string &result, const std::string &expected)
 		{ assertNotEqual(stringView{result.c_str(), result.length()}, stringView{expected.c_str(), expected.length()}); }
 #if __cplusplus >= 201703L
@@ -300,15 +540,347 @@ public:
 		{ assertNotEqual(stringView{result.data(), result.length()}, stringView{expected.data(), expected.length()}); }
 #endif
 
-	CRUNCH_VIS void assertNull(const void *const result);
-	CRUNCH_VIS void assertNotNull(const void *const result);
+	// Compares two ranges of integers, enums or pointers, reporting the index and values of the
+	// first elements that differ along with the elements around them
+	template<typename T, typename = enableIf<crunch::internal::isBitwiseComparable<T>::value>>
+		void assertRangeEqual(const T *const result, const T *const expected, const std::size_t count)
+	{
+		const auto offset{crunch::internal::firstMismatch(result, expected, count * sizeof(T))};
+		if (CRUNCH_UNLIKELY(offset != count * sizeof(T)))
+			crunch::internal::rangeFailure(result, expected, count, offset / sizeof(T), sizeof(T),
+				crunch::internal::elementKind<T>());
+	}
+
+	template<typename T> void assertRangeEqual(const std::vector<T> &result, const std::vector<T> &expected)
+	{
+		if (CRUNCH_UNLIKELY(result.size() != expected.size()))
+			crunch::internal::rangeLengthFailure(result.size(), expected.size());
+		assertRangeEqual(result.data(), expected.data(), expected.size());
+	}
+
+	template<typename T, std::size_t count>
+		void assertRangeEqual(const std::array<T, count> &result, const std::array<T, count> &expected)
+		{ assertRangeEqual(result.data(), expected.data(), count); }
+
+	// Asserts that result is no more than maxUlps representable values (units in the last place) away
+	// from expected. Infinities of the same sign are equal, and not a number is never equal to anything.
+	void assertUlpEqual(const float result, const float expected, const uint64_t maxUlps = 4)
+		{ assertUlpEqual(&result, &expected, 1, maxUlps); }
+	void assertUlpEqual(const double result, const double expected, const uint64_t maxUlps = 4)
+		{ assertUlpEqual(&result, &expected, 1, maxUlps); }
+
+	void assertUlpEqual(const float *const result, const float *const expected, const std::size_t count,
+		const uint64_t maxUlps = 4)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::countUlpFailures(result, expected, count, maxUlps)))
+			crunch::internal::ulpFailure(result, expected, count, maxUlps);
+	}
+
+	void assertUlpEqual(const double *const result, const double *const expected, const std::size_t count,
+		const uint64_t maxUlps = 4)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::countUlpFailures(result, expected, count, maxUlps)))
+			crunch::internal::ulpFailure(result, expected, count, maxUlps);
+	}
+
+	template<typename T, typename = enableIf<std::is_floating_point<T>::value>>
+		void assertUlpEqual(const std::vector<T> &result, const std::vector<T> &expected, const uint64_t maxUlps = 4)
+	{
+		if (CRUNCH_UNLIKELY(result.size() != expected.size()))
+			crunch::internal::rangeLengthFailure(result.size(), expected.size());
+		assertUlpEqual(result.data(), expected.data(), expected.size(), maxUlps);
+	}
+
+	// Asserts that result is equal to expected, or differs from it by no more than the larger of the
+	// absolute tolerance and the relative tolerance times the magnitude of expected
+	void assertNear(const float result, const float expected, const double relative, const double absolute = 0.0)
+		{ assertNear(&result, &expected, 1, relative, absolute); }
+	void assertNear(const double result, const double expected, const double relative, const double absolute = 0.0)
+		{ assertNear(&result, &expected, 1, relative, absolute); }
+
+	void assertNear(const float *const result, const float *const expected, const std::size_t count,
+		const double relative, const double absolute = 0.0)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::countToleranceFailures(result, expected, count, relative, absolute)))
+			crunch::internal::toleranceFailure(result, expected, count, relative, absolute);
+	}
+
+	void assertNear(const double *const result, const double *const expected, const std::size_t count,
+		const double relative, const double absolute = 0.0)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::countToleranceFailures(result, expected, count, relative, absolute)))
+			crunch::internal::toleranceFailure(result, expected, count, relative, absolute);
+	}
+
+	template<typename T, typename = enableIf<std::is_floating_point<T>::value>>
+		void assertNear(const std::vector<T> &result, const std::vector<T> &expected, const double relative,
+			const double absolute = 0.0)
+	{
+		if (CRUNCH_UNLIKELY(result.size() != expected.size()))
+			crunch::internal::rangeLengthFailure(result.size(), expected.size());
+		assertNear(result.data(), expected.data(), expected.size(), relative, absolute);
+	}
+
 	template<typename T> void assertNull(std::unique_ptr<T> &result) { assertNull(result.get()); }
 	template<typename T> void assertNotNull(std::unique_ptr<T> &result) { assertNotNull(result.get()); }
 	template<typename T> void assertNull(const std::unique_ptr<T> &result) { assertNull(result.get()); }
 	template<typename T> void assertNotNull(const std::unique_ptr<T> &result) { assertNotNull(result.get()); }
 
-	CRUNCH_VIS void assertGreaterThan(const long result, const long expected);
-	CRUNCH_VIS void assertLessThan(const long result, const long expected);
+	// Expectations check what the assertions of the same names do, but one that fails is recorded along
+	// with where it was checked and the test carries on. Once the test is over it fails, reporting every
+	// expectation that failed together. Expectations must be checked on the thread running the test.
+	void expectTrue(const bool value, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(!value))
+			crunch::internal::expectationFailure(file, line, [&]() { crunch::internal::booleanFailure(value); });
+	}
+
+	void expectFalse(const bool value, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(value))
+			crunch::internal::expectationFailure(file, line, [&]() { crunch::internal::booleanFailure(value); });
+	}
+
+	template<typename T, typename U, typename = enableIf<crunch::internal::isNumeric<T>::value &&
+		crunch::internal::isNumeric<U>::value>> void expectEqual(const T result, const U expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result != T(expected)))
+			crunch::internal::expectationFailure(file, line, [&]() { assertEqual(result, expected); });
+	}
+
+	template<typename T, typename = enableIf<std::is_enum<T>::value>> void expectEqual(const T result,
+		const T expected, const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result != expected))
+			crunch::internal::expectationFailure(file, line, [&]() { assertEqual(result, expected); });
+	}
+
+	void expectEqual(const double result, const double expected, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(!crunch::internal::withinDelta(result, expected)))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { crunch::internal::equalFailure(result, expected); });
+	}
+
+	void expectEqual(const void *const result, const void *const expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result != expected))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { crunch::internal::equalFailure(result, expected); });
+	}
+
+	void expectEqual(const char *const result, const char *const expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(std::strcmp(result, expected) != 0))
+			crunch::internal::expectationFailure(file, line, [&]() { assertEqual(result, expected); });
+	}
+
+	void expectEqual(const std::string &result, const std::string &expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result != expected))
+			crunch::internal::expectationFailure(file, line, [&]() { assertEqual(result, expected); });
+	}
+#if __cplusplus >= 201703L
+	void expectEqual(const std::string_view &result, const std::string_view &expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result != expected))
+			crunch::internal::expectationFailure(file, line, [&]() { assertEqual(result, expected); });
+	}
+#endif
+
+	template<typename T, typename = enableIf<crunch::internal::isPrintable<T>::value>>
+		void expectEqual(const T &result, const T &expected, const char *const file = CRUNCH_CALLER_FILE,
+			const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(!(result == expected)))
+			crunch::internal::expectationFailure(file, line, [&]() { assertEqual(result, expected); });
+	}
+
+	void expectEqual(const void *const result, const void *const expected, const std::size_t expectedLength,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(std::memcmp(result, expected, expectedLength) != 0))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { assertEqual(result, expected, expectedLength); });
+	}
+
+	template<typename T, typename U, typename = enableIf<crunch::internal::isNumeric<T>::value &&
+		crunch::internal::isNumeric<U>::value>> void expectNotEqual(const T result, const U expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result == T(expected)))
+			crunch::internal::expectationFailure(file, line, [&]() { assertNotEqual(result, expected); });
+	}
+
+	template<typename T, typename = enableIf<std::is_enum<T>::value>> void expectNotEqual(const T result,
+		const T expected, const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result == expected))
+			crunch::internal::expectationFailure(file, line, [&]() { assertNotEqual(result, expected); });
+	}
+
+	void expectNotEqual(const double result, const double expected, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::withinDelta(result, expected)))
+			crunch::internal::expectationFailure(file, line, [&]() { crunch::internal::notEqualFailure(result); });
+	}
+
+	void expectNotEqual(const void *const result, const void *const expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result == expected))
+			crunch::internal::expectationFailure(file, line, [&]() { crunch::internal::notEqualFailure(result); });
+	}
+
+	void expectNotEqual(const char *const result, const char *const expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(std::strcmp(result, expected) == 0))
+			crunch::internal::expectationFailure(file, line, [&]() { assertNotEqual(result, expected); });
+	}
+
+	void expectNotEqual(const std::string &result, const std::string &expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result == expected))
+			crunch::internal::expectationFailure(file, line, [&]() { assertNotEqual(result, expected); });
+	}
+#if __cplusplus >= 201703L
+	void expectNotEqual(const std::string_view &result, const std::string_view &expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result == expected))
+			crunch::internal::expectationFailure(file, line, [&]() { assertNotEqual(result, expected); });
+	}
+#endif
+
+	template<typename T, typename = enableIf<crunch::internal::isPrintable<T>::value>>
+		void expectNotEqual(const T &result, const T &expected, const char *const file = CRUNCH_CALLER_FILE,
+			const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result == expected))
+			crunch::internal::expectationFailure(file, line, [&]() { assertNotEqual(result, expected); });
+	}
+
+	void expectNotEqual(const void *const result, const void *const expected, const std::size_t expectedLength,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(std::memcmp(result, expected, expectedLength) == 0))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { assertNotEqual(result, expected, expectedLength); });
+	}
+
+	void expectNull(const void *const result, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result != nullptr))
+			crunch::internal::expectationFailure(file, line, [&]() { crunch::internal::nullFailure(result); });
+	}
+
+	void expectNotNull(const void *const result, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result == nullptr))
+			crunch::internal::expectationFailure(file, line, []() { crunch::internal::notNullFailure(); });
+	}
+
+	void expectGreaterThan(const long result, const long expected, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result <= expected))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { crunch::internal::greaterThanFailure(result, expected); });
+	}
+
+	void expectLessThan(const long result, const long expected, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result >= expected))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { crunch::internal::lessThanFailure(result, expected); });
+	}
+
+	template<typename T, typename = enableIf<crunch::internal::isBitwiseComparable<T>::value>>
+		void expectRangeEqual(const T *const result, const T *const expected, const std::size_t count,
+			const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		const auto offset{crunch::internal::firstMismatch(result, expected, count * sizeof(T))};
+		if (CRUNCH_UNLIKELY(offset != count * sizeof(T)))
+			crunch::internal::expectationFailure(file, line, [&]()
+			{
+				crunch::internal::rangeFailure(result, expected, count, offset / sizeof(T), sizeof(T),
+					crunch::internal::elementKind<T>());
+			});
+	}
+
+	template<typename T> void expectRangeEqual(const std::vector<T> &result, const std::vector<T> &expected,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(result.size() != expected.size()))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { crunch::internal::rangeLengthFailure(result.size(), expected.size()); });
+		else
+			expectRangeEqual(result.data(), expected.data(), expected.size(), file, line);
+	}
+
+	void expectUlpEqual(const float result, const float expected, const uint64_t maxUlps = 4,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+		{ expectUlpEqual(&result, &expected, 1, maxUlps, file, line); }
+	void expectUlpEqual(const double result, const double expected, const uint64_t maxUlps = 4,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+		{ expectUlpEqual(&result, &expected, 1, maxUlps, file, line); }
+
+	void expectUlpEqual(const float *const result, const float *const expected, const std::size_t count,
+		const uint64_t maxUlps = 4, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::countUlpFailures(result, expected, count, maxUlps)))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { crunch::internal::ulpFailure(result, expected, count, maxUlps); });
+	}
+
+	void expectUlpEqual(const double *const result, const double *const expected, const std::size_t count,
+		const uint64_t maxUlps = 4, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::countUlpFailures(result, expected, count, maxUlps)))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { crunch::internal::ulpFailure(result, expected, count, maxUlps); });
+	}
+
+	void expectNear(const float result, const float expected, const double relative, const double absolute = 0.0,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+		{ expectNear(&result, &expected, 1, relative, absolute, file, line); }
+	void expectNear(const double result, const double expected, const double relative, const double absolute = 0.0,
+		const char *const file = CRUNCH_CALLER_FILE, const uint32_t line = CRUNCH_CALLER_LINE)
+		{ expectNear(&result, &expected, 1, relative, absolute, file, line); }
+
+	void expectNear(const float *const result, const float *const expected, const std::size_t count,
+		const double relative, const double absolute = 0.0, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::countToleranceFailures(result, expected, count, relative, absolute)))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { crunch::internal::toleranceFailure(result, expected, count, relative, absolute); });
+	}
+
+	void expectNear(const double *const result, const double *const expected, const std::size_t count,
+		const double relative, const double absolute = 0.0, const char *const file = CRUNCH_CALLER_FILE,
+		const uint32_t line = CRUNCH_CALLER_LINE)
+	{
+		if (CRUNCH_UNLIKELY(crunch::internal::countToleranceFailures(result, expected, count, relative, absolute)))
+			crunch::internal::expectationFailure(file, line,
+				[&]() { crunch::internal::toleranceFailure(result, expected, count, relative, absolute); });
+	}
 
 	CRUNCH_VIS testsuite() noexcept;
 
@@ -350,11 +922,14 @@ namespace crunch
 		private:
 			std::function<void ()> testFunc{nullptr};
 			const char *testName{nullptr};
+			// The table entry the test was registered from, if it was, which it's then run through
+			const testEntry_t *entry{nullptr};
 
 		public:
 			// clang 5 has a bad time with this if we don't define it this way.
 			cxxTest() noexcept { } // NOLINT(modernize-use-equals-default, hicpp-use-equals-default)
 			CRUNCH_VIS cxxTest(std::function<void ()> &&func, const char *const name) noexcept;
+			CRUNCH_VIS cxxTest(const testEntry_t &tableEntry) noexcept;
 			cxxTest(const cxxTest &) = default;
 			cxxTest(cxxTest &&) = default;
 			~cxxTest() noexcept = default;
@@ -362,17 +937,47 @@ namespace crunch
 			cxxTest &operator =(cxxTest &&) = default;
 
 			const char *name() const noexcept { return testName; }
+			// The comma separated tags of a test registered from a table, which are kept there rather than
+			// recorded with the others, or nullptr
+			const char *tags() const noexcept { return entry ? entry->tags : nullptr; }
 			const std::function<void ()> &function() const noexcept { return testFunc; }
+			void run(testsuite &suite) const
+			{
+				if (entry)
+					entry->run(suite);
+				else
+					testFunc();
+			}
 
 			void swap(cxxTest &other) noexcept
 			{
-				auto tmp{*this};
-				*this = other;
-				other = tmp;
+				auto tmp{std::move(*this)};
+				*this = std::move(other);
+				other = std::move(tmp);
 			}
 		};
 
+		using suiteFactory_t = std::unique_ptr<testsuite> (*)();
+
 		CRUNCHpp_API void registerTestClass(std::unique_ptr<testsuite> &&suite, const char *name);
+		// Registers a test class that factory constructs only once its tests are about to be run
+		CRUNCHpp_API void registerTestClass(suiteFactory_t factory, const char *name);
+
+		// Notes a test the CRUNCHpp_TEST() macros register as its test library is loaded, so the test can
+		// be listed without constructing its test class. suite is the typeid() name of that class.
+		CRUNCHpp_API void noteTest(const char *suite, const char *test, const char *tags) noexcept;
+
+		// Each test the macros register names one of these, keyed on a type local to registerTests(), so
+		// the test is noted by the static initialisation of its library. They are hidden so the library
+		// doesn't gain unique symbols, which would stop it from ever being unloaded.
+		template<typename suite_t, typename test_t> struct CRUNCH_HIDDEN testNote_t final
+			{ static const bool noted; };
+		template<typename suite_t, typename test_t> const bool testNote_t<suite_t, test_t>::noted
+			{(noteTest(typeid(suite_t).name(), test_t::testName(), test_t::testTags()), true)};
+
+		template<typename table_t> struct CRUNCH_HIDDEN tableNote_t final
+			{ static const bool noted; };
+		template<typename table_t> const bool tableNote_t<table_t>::noted{(table_t::noteTests(), true)};
 	} // namespace internal
 
 	template<typename T> using remove_const_t = typename std::remove_const<T>::type;
@@ -398,10 +1003,18 @@ namespace crunch
 
 	template<typename T, typename... args_t> inline typename makeUnique_t<T>::invalidType
 		makeUnique(args_t &&...) noexcept = delete;
+
+	namespace internal
+	{
+		// Always exported, even from test libraries built with hidden visibility, so the runner can read which
+		// test classes a library registers from its dynamic symbol table without loading it
+		template<typename TestClass> CRUNCH_TEMPLATE_VIS std::unique_ptr<testsuite> makeTestClass()
+			{ return makeUnique<TestClass>(); }
+	} // namespace internal
 } // namespace crunch
 
 template<typename TestClass> void registerTestClasses()
-	{ crunch::internal::registerTestClass(crunch::makeUnique<TestClass>(), typeid(TestClass).name()); }
+	{ crunch::internal::registerTestClass(&crunch::internal::makeTestClass<TestClass>, typeid(TestClass).name()); }
 
 template<typename TestClass, typename ...TestClasses>
 typename std::enable_if<sizeof...(TestClasses) != 0, void>::type registerTestClasses()
@@ -410,8 +1023,51 @@ typename std::enable_if<sizeof...(TestClasses) != 0, void>::type registerTestCla
 	registerTestClasses<TestClasses...>();
 }
 
-#define CRUNCHpp_TEST(name) registerTest([this](){ this->name(); }, #name);
+// Notes the test as its library is loaded, so --list can name it without constructing its test class. Each
+// note is in a block of its own as a test may be registered more than once. Only test classes that register
+// no tests through these macros are constructed to be listed, so any a class registers by calling
+// registerTest() directly alongside them go unlisted.
+#define CRUNCHpp_NOTE_TEST(name, tags) \
+	{ \
+		struct crunchNoted_ ## name final \
+		{ \
+			static const char *testName() noexcept { return #name; } \
+			static const char *testTags() noexcept { return tags; } \
+		}; \
+		static_cast<void>(crunch::internal::testNote_t<typename std::remove_reference<decltype(*this)>::type, \
+			crunchNoted_ ## name>::noted); \
+	}
+
+#define CRUNCHpp_TEST(name) \
+	CRUNCHpp_MANIFEST_RECORD("T", #name) CRUNCHpp_NOTE_TEST(name, nullptr) \
+	registerMacroTest([this](){ this->name(); }, #name, nullptr);
 #define CXX_TEST(name) CRUNCHpp_TEST(name)
+#define CRUNCHpp_TAGGED_TEST(name, tags) \
+	CRUNCHpp_MANIFEST_RECORD("T", #name) CRUNCHpp_NOTE_TEST(name, tags) \
+	registerMacroTest([this](){ this->name(); }, #name, tags);
+
+// Defines registerTests() for a test class from a table of CRUNCHpp_TABLE_TEST() and CRUNCHpp_TABLE_TAGGED_TEST()
+// entries, which is built at compile time and registered in one go, for test classes with very many tests
+#define CRUNCHpp_TEST_TABLE(...) \
+	void registerTests() final \
+	{ \
+		using crunchSuite_t = typename std::remove_reference<decltype(*this)>::type; \
+		static constexpr crunch::internal::testEntry_t crunchTests[]{__VA_ARGS__}; \
+		struct crunchNotedTable_t final \
+		{ \
+			static void noteTests() noexcept \
+			{ \
+				for (const auto &entry : crunchTests) \
+					crunch::internal::noteTest(typeid(crunchSuite_t).name(), entry.name, entry.tags); \
+			} \
+		}; \
+		static_cast<void>(crunch::internal::tableNote_t<crunchNotedTable_t>::noted); \
+		registerTestTable(crunchTests, sizeof(crunchTests) / sizeof(*crunchTests)); \
+	}
+#define CRUNCHpp_TABLE_TEST(name) \
+	{#name, nullptr, &crunch::internal::runTableTest<crunchSuite_t, &crunchSuite_t::name>}
+#define CRUNCHpp_TABLE_TAGGED_TEST(name, tags) \
+	{#name, tags, &crunch::internal::runTableTest<crunchSuite_t, &crunchSuite_t::name>}
 
 #define CRUNCHpp_TESTS(...) \
 CRUNCHpp_EXPORT void registerCXXTests(); \
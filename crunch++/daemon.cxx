@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include "daemon.hxx"
+#include "logger.hxx"
+
+namespace crunch
+{
+#ifndef _WIN32
+	const bool daemonSupported{true};
+#else
+	const bool daemonSupported{false};
+#endif
+	bool residentLibraries{false};
+
+	bool parseRequest(const std::string &line, testRequest_t &request)
+	{
+		std::vector<std::string> words{};
+		for (std::size_t begin{line.find_first_not_of(" \t")}; begin != std::string::npos;)
+		{
+			const auto end{line.find_first_of(" \t", begin)};
+			words.emplace_back(line.substr(begin, end - begin));
+			begin = line.find_first_not_of(" \t", end);
+		}
+		if (words.size() == 1 && words[0] == "quit")
+		{
+			request.quit = true;
+			return true;
+		}
+		if (words.size() < 2 || words[0] != "run")
+			return false;
+		request.library = std::move(words[1]);
+		request.patterns.assign(std::make_move_iterator(words.begin() + 2), std::make_move_iterator(words.end()));
+		return true;
+	}
+
+#ifndef _WIN32
+	// The longest request line we'll take from a client
+	constexpr static std::size_t maxRequestLength{65536};
+
+	struct residentLibrary_t final
+	{
+		void *handle;
+		// Which file the library was loaded from, and as it was then, so we can tell when it's rebuilt
+		fileStamp_t file;
+	};
+
+	static std::unordered_map<std::string, residentLibrary_t> loadedLibraries{};
+
+	fileStamp_t fileStamp_t::of(const struct stat &file) noexcept
+	{
+#ifdef __APPLE__
+		return {file.st_dev, file.st_ino, file.st_size, file.st_mtimespec};
+#else
+		return {file.st_dev, file.st_ino, file.st_size, file.st_mtim};
+#endif
+	}
+
+	bool fileStamp_t::operator ==(const fileStamp_t &other) const noexcept
+	{
+		return device == other.device && inode == other.inode && size == other.size &&
+			modified.tv_sec == other.modified.tv_sec && modified.tv_nsec == other.modified.tv_nsec;
+	}
+
+	void *residentLibrary(const char *const path)
+	{
+		struct stat file{};
+		// Only a library we can find the file of can be told apart from a rebuilt copy, and released when it is
+		if (stat(path, &file))
+		{
+			testPrintf("Could not find test library %s: %s\n", path, strerror(errno));
+			return nullptr;
+		}
+		const auto entry{loadedLibraries.find(path)};
+		if (entry != loadedLibraries.end())
+		{
+			const auto &library{entry->second};
+			if (library.file == fileStamp_t::of(file))
+				return library.handle;
+			dlclose(library.handle);
+			loadedLibraries.erase(entry);
+			// Libraries with unique symbols, which inline and template statics can become, are never unloaded
+			auto *const resident{dlopen(path, RTLD_LAZY | RTLD_NOLOAD)};
+			if (resident)
+			{
+				dlclose(resident);
+				testPrintf("Warning: test library %s can't be unloaded, so the daemon must be restarted to pick up "
+					"changes to it\n", path);
+			}
+		}
+		auto *const handle{dlopen(path, RTLD_LAZY)};
+		if (handle)
+		{
+			loadedLibraries.emplace(path, residentLibrary_t{handle, fileStamp_t::of(file)});
+		}
+		return handle;
+	}
+
+	testDaemon_t::testDaemon_t(std::string path_) : path{std::move(path_)}
+	{
+		sockaddr_un address{};
+		if (path.length() >= sizeof(address.sun_path))
+			return;
+		address.sun_family = AF_UNIX;
+		memcpy(address.sun_path, path.c_str(), path.length() + 1);
+		// A socket left behind by a daemon that was killed would otherwise stop us binding
+		struct stat file{};
+		if (!lstat(path.c_str(), &file) && S_ISSOCK(file.st_mode))
+			unlink(path.c_str());
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd == -1)
+			return;
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) || listen(fd, SOMAXCONN))
+		{
+			close(fd);
+			fd = -1;
+			return;
+		}
+		// A client going away while its results are streamed to it must not take the daemon down with it
+		signal(SIGPIPE, SIG_IGN); // NOLINT(cert-err33-c)
+	}
+
+	testDaemon_t::~testDaemon_t() noexcept
+	{
+		if (fd == -1)
+			return;
+		close(fd);
+		unlink(path.c_str());
+	}
+
+	FILE *testDaemon_t::accept(testRequest_t &request)
+	{
+		const auto client{::accept(fd, nullptr, nullptr)};
+		if (client == -1)
+		{
+			if (errno != EINTR && errno != ECONNABORTED)
+			{
+				close(fd);
+				fd = -1;
+			}
+			return nullptr;
+		}
+		// A client that never finishes its request must not hold up the rest
+		const timeval timeout{5, 0};
+		setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		std::string line{};
+		std::array<char, 4096> buffer{};
+		while (line.find('\n') == std::string::npos && line.length() < maxRequestLength)
+		{
+			const auto length{recv(client, buffer.data(), buffer.size(), 0)};
+			if (length <= 0)
+			{
+				if (length == -1 && errno == EINTR)
+					continue;
+				break;
+			}
+			line.append(buffer.data(), std::size_t(length));
+		}
+		const auto newline{line.find('\n')};
+		if (newline == std::string::npos || !parseRequest(line.substr(0, newline), request))
+		{
+			close(client);
+			return nullptr;
+		}
+		auto *const stream{fdopen(client, "w")};
+		if (!stream)
+			close(client);
+		return stream;
+	}
+#else
+	void *residentLibrary(const char *) { return nullptr; }
+	testDaemon_t::testDaemon_t(std::string path_) : path{std::move(path_)} { }
+	testDaemon_t::~testDaemon_t() noexcept = default;
+	FILE *testDaemon_t::accept(testRequest_t &) { return nullptr; }
+#endif
+} // namespace crunch
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef DAEMON__HXX
+#define DAEMON__HXX
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+#include "crunch++.h"
+
+namespace crunch
+{
+	// Whether --daemon can be honoured on this platform
+	CRUNCHpp_API const bool daemonSupported;
+	// Whether the runner is a daemon, so keeps the test libraries it loads around between requests
+	CRUNCHpp_API bool residentLibraries;
+
+#ifndef _WIN32
+	// Identifies a file as it was when stamped, so it can be told when the file has since been
+	// rewritten, or replaced by another moved in over it
+	struct fileStamp_t final
+	{
+		dev_t device;
+		ino_t inode;
+		off_t size;
+		timespec modified;
+
+		CRUNCH_VIS static fileStamp_t of(const struct stat &file) noexcept;
+		CRUNCH_VIS bool operator ==(const fileStamp_t &other) const noexcept;
+		bool operator !=(const fileStamp_t &other) const noexcept { return !(*this == other); }
+	};
+#endif
+
+	// Returns a handle on the test library at path, which stays loaded for later requests. If the library's
+	// file has changed since it was loaded, the old copy is unloaded and the new one loaded in its place.
+	// Returns nullptr if the library can't be loaded, with dlerror() saying why, or if there's no file at path,
+	// which is reported, so one the loader would only find by searching for it is never loaded.
+	CRUNCHpp_API void *residentLibrary(const char *path);
+
+	// A request from a client of the daemon, which is one line of the form "run LIBRARY [PATTERN]..."
+	// to run the tests of a library, optionally only those matching the --filter style patterns, or "quit"
+	struct testRequest_t final
+	{
+		std::string library{};
+		std::vector<std::string> patterns{};
+		bool quit{false};
+	};
+
+	// Parses a request line, without its trailing newline, returning whether it was a valid request
+	CRUNCHpp_API bool parseRequest(const std::string &line, testRequest_t &request);
+
+	// Listens on a Unix domain socket for requests to run tests, one client at a time
+	struct testDaemon_t final
+	{
+	private:
+		int32_t fd{-1};
+		std::string path;
+
+	public:
+		CRUNCH_VIS testDaemon_t(std::string path_);
+		testDaemon_t(const testDaemon_t &) = delete;
+		testDaemon_t(testDaemon_t &&) = delete;
+		CRUNCH_VIS ~testDaemon_t() noexcept;
+		testDaemon_t &operator =(const testDaemon_t &) = delete;
+		testDaemon_t &operator =(testDaemon_t &&) = delete;
+
+		bool valid() const noexcept { return fd != -1; }
+		// Waits for a client to make a request, returning the stream to reply to it on, which the caller
+		// must close. Returns nullptr if the client didn't make a valid request, or if the daemon can no
+		// longer accept clients, after which it is no longer valid.
+		CRUNCH_VIS FILE *accept(testRequest_t &request);
+	};
+} // namespace crunch
+
+#endif /*DAEMON__HXX*/
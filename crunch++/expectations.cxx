@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <string>
+#include <vector>
+#include "expectations.hxx"
+#include "logger.hxx"
+
+namespace crunch
+{
+	// How many failed expectations are kept for each test. Once a test has this many, the rest are only counted.
+	constexpr static std::size_t maxRecordedExpectations{100};
+	// What the failures of assertions start with, which is left off them when they are the failure of an expectation
+	constexpr static char assertionPrefix[]{"Assertion failure: "};
+
+	struct expectations_t final
+	{
+		std::vector<std::string> failures{};
+		std::size_t unrecorded{0};
+	};
+
+	// The expectations that have failed in the test being run on this thread
+	static thread_local expectations_t expectations{};
+
+	namespace internal
+	{
+		void expectationFailure(const char *const file, const uint32_t line, void (*const check)(const void *),
+			const void *const context)
+		{
+			// A test that fails an expectation in a loop stays cheap to run once we've got plenty to report
+			if (expectations.failures.size() >= maxRecordedExpectations)
+			{
+				++expectations.unrecorded;
+				return;
+			}
+			std::string failure{};
+			auto *const outer{deferFailures(&failure)};
+			try
+				{ check(context); }
+			catch (threadExit_t &) { } // NOLINT(bugprone-empty-catch)
+			catch (...)
+			{
+				deferFailures(outer);
+				throw;
+			}
+			deferFailures(outer);
+			if (failure.compare(0, sizeof(assertionPrefix) - 1U, assertionPrefix) == 0)
+				failure.erase(0, sizeof(assertionPrefix) - 1U);
+			if (file && *file)
+				failure.insert(0, std::string{file} + ':' + std::to_string(line) + ": ");
+			expectations.failures.emplace_back(std::move(failure));
+		}
+	} // namespace internal
+
+	void discardExpectations() noexcept
+	{
+		expectations.failures.clear();
+		expectations.unrecorded = 0;
+	}
+
+	bool reportExpectations(const bool alreadyFailed)
+	{
+		const auto count{expectations.failures.size() + expectations.unrecorded};
+		if (!count)
+			return false;
+		const auto *const noun{count == 1 ? "expectation" : "expectations"};
+		if (alreadyFailed)
+			testPrintf("%zu %s failed before that:\n", count, noun);
+		else
+			logResult(RESULT_FAILURE, "%zu %s failed", count, noun);
+		for (const auto &failure : expectations.failures)
+		{
+			// Anything printed along with the failure, such as a hexdump, ends up indented under it
+			for (std::size_t begin{0}; begin < failure.length();)
+			{
+				auto end{failure.find('\n', begin)};
+				if (end == std::string::npos)
+					end = failure.length();
+				if (end != begin)
+					testPrintf("\t%.*s\n", int(end - begin), failure.data() + begin);
+				begin = end + 1U;
+			}
+		}
+		if (expectations.unrecorded)
+			testPrintf("\t%zu more not recorded\n", expectations.unrecorded);
+		discardExpectations();
+		return true;
+	}
+} // namespace crunch
@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef EXPECTATIONS__HXX
+#define EXPECTATIONS__HXX
+
+#include "crunch++.h"
+
+namespace crunch
+{
+	// Forgets the expectations that have failed on the calling thread, as when a new test starts
+	CRUNCHpp_API void discardExpectations() noexcept;
+	// Reports the expectations that failed on the calling thread during the test just run, returning whether
+	// there were any. They are logged as a failure of the test unless alreadyFailed says it already has been.
+	CRUNCHpp_API bool reportExpectations(bool alreadyFailed);
+} // namespace crunch
+
+#endif /*EXPECTATIONS__HXX*/
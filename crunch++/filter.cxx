@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <mutex>
+#include <unordered_map>
+#include <substrate/utility>
+#include "filter.hxx"
+#include "history.hxx"
+
+namespace crunch
+{
+	std::vector<std::string> nameFilters{};
+	std::vector<std::string> tagFilters{};
+
+	// The tags of each suite's tests by test name, kept out of cxxTest itself to preserve its layout
+	static std::unordered_map<const testsuite *, std::unordered_map<std::string, std::vector<std::string>>> testTags{};
+	static std::mutex testTagsLock{};
+
+	bool globMatch(const char *pattern, const char *text) noexcept
+	{
+		// Where to resume from if what follows the last '*' seen fails to match
+		const char *starPattern{nullptr};
+		const char *starText{nullptr};
+		while (*text)
+		{
+			if (*pattern == '*')
+			{
+				starPattern = ++pattern;
+				starText = text;
+			}
+			else if (*pattern == '?' || *pattern == *text)
+			{
+				++pattern;
+				++text;
+			}
+			else if (starPattern)
+			{
+				pattern = starPattern;
+				text = ++starText;
+			}
+			else
+				return false;
+		}
+		while (*pattern == '*')
+			++pattern;
+		return !*pattern;
+	}
+
+	static std::vector<std::string> splitTags(const char *tags)
+	{
+		std::vector<std::string> result{};
+		std::string tag{};
+		for (; tags && *tags; ++tags)
+		{
+			if (*tags == ',')
+			{
+				if (!tag.empty())
+					result.emplace_back(std::move(tag));
+				tag.clear();
+			}
+			else if (*tags != ' ' && *tags != '\t')
+				tag += *tags;
+		}
+		if (!tag.empty())
+			result.emplace_back(std::move(tag));
+		return result;
+	}
+
+	void setTags(const testsuite &suite, const char *const test, const char *const tags)
+	{
+		auto splitTags_{splitTags(tags)};
+		std::lock_guard<std::mutex> lock{testTagsLock};
+		testTags[&suite][test] = std::move(splitTags_);
+	}
+
+	void forgetTags(const testsuite &suite) noexcept
+	{
+		std::lock_guard<std::mutex> lock{testTagsLock};
+		testTags.erase(&suite);
+	}
+
+	// Checks a test against a set of filters, returning true if it is included by one of them
+	// (or there are none that include) and excluded by none
+	template<typename matches_t> static bool selectedBy(const std::vector<std::string> &filters, matches_t &&matches)
+	{
+		bool haveIncludes{false};
+		bool included{false};
+		for (const auto &filter : filters)
+		{
+			if (filter[0] == '-')
+			{
+				if (matches(filter.c_str() + 1))
+					return false;
+			}
+			else
+			{
+				haveIncludes = true;
+				included |= matches(filter.c_str());
+			}
+		}
+		return included || !haveIncludes;
+	}
+
+	// Keeps only the tests the filters select, with tagsOf(index) giving the tags of the test at index
+	template<typename tagsOf_t> static void selectTests(std::vector<internal::cxxTest> &tests, tagsOf_t &&tagsOf)
+	{
+		std::string prefix{};
+		if (currentSuite())
+			prefix = substrate::decode_typename(currentSuite()) + "::";
+
+		std::size_t kept{0};
+		for (std::size_t i{0}; i < tests.size(); ++i)
+		{
+			const auto name{prefix + tests[i].name()};
+			const std::vector<std::string> &testTags_{tagsOf(i)};
+			const auto selected
+			{
+				selectedBy(nameFilters, [&](const char *const pattern) { return globMatch(pattern, name.c_str()); }) &&
+				selectedBy(tagFilters, [&](const char *const pattern)
+				{
+					for (const auto &tag : testTags_)
+					{
+						if (globMatch(pattern, tag.c_str()))
+							return true;
+					}
+					return false;
+				})
+			};
+			if (!selected)
+				continue;
+			// Moving a test onto itself isn't safe for every member type, so only move those that shift down
+			if (kept != i)
+				tests[kept] = std::move(tests[i]);
+			++kept;
+		}
+		tests.erase(tests.begin() + std::ptrdiff_t(kept), tests.end());
+	}
+
+	void selectFiltered(const testsuite &suite, std::vector<internal::cxxTest> &tests)
+	{
+		if (nameFilters.empty() && tagFilters.empty())
+			return;
+		std::unordered_map<std::string, std::vector<std::string>> suiteTags{};
+		{
+			std::lock_guard<std::mutex> lock{testTagsLock};
+			const auto entry{testTags.find(&suite)};
+			if (entry != testTags.end())
+				suiteTags = entry->second;
+		}
+		static const std::vector<std::string> noTags{};
+		std::vector<std::string> tableTags{};
+
+		selectTests(tests, [&](const std::size_t index) -> const std::vector<std::string> &
+		{
+			// Tests registered from a table carry their tags with them, so are only split up here
+			if (tests[index].tags())
+			{
+				tableTags = splitTags(tests[index].tags());
+				return tableTags;
+			}
+			const auto tags{suiteTags.find(tests[index].name())};
+			return tags == suiteTags.end() ? noTags : tags->second;
+		});
+	}
+
+	void selectFiltered(std::vector<internal::cxxTest> &tests, const std::vector<const char *> &tags)
+	{
+		if (nameFilters.empty() && tagFilters.empty())
+			return;
+		std::vector<std::vector<std::string>> testTags_{};
+		testTags_.reserve(tags.size());
+		for (const auto *const tagList : tags)
+			testTags_.emplace_back(splitTags(tagList));
+		selectTests(tests, [&](const std::size_t index) -> const std::vector<std::string> &
+			{ return testTags_[index]; });
+	}
+} // namespace crunch
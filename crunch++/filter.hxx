@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef FILTER__HXX
+#define FILTER__HXX
+
+#include <string>
+#include <vector>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// Glob patterns over suite::test names, and tags, selecting which tests to run. An entry
+	// starting with '-' excludes what it matches rather than including it.
+	CRUNCHpp_API std::vector<std::string> nameFilters;
+	CRUNCHpp_API std::vector<std::string> tagFilters;
+
+	// Matches text against a glob pattern in which '*' matches any run of characters and '?' any one
+	bool globMatch(const char *pattern, const char *text) noexcept;
+	// Records the comma separated tags a test was registered with
+	void setTags(const testsuite &suite, const char *test, const char *tags);
+	void forgetTags(const testsuite &suite) noexcept;
+	// Drops the tests of the suite being run that the filters exclude, so they are never scheduled
+	void selectFiltered(const testsuite &suite, std::vector<internal::cxxTest> &tests);
+	// As above, for tests not yet registered with their suite, given the comma separated tags of each
+	void selectFiltered(std::vector<internal::cxxTest> &tests, const std::vector<const char *> &tags);
+} // namespace crunch
+
+#endif /*FILTER__HXX*/
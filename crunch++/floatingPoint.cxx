@@ -0,0 +1,337 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#include "crunch++.h"
+#include "core.hxx"
+#include "logger.hxx"
+
+namespace crunch
+{
+	namespace internal
+	{
+		template<typename T> struct floatBits_t;
+		template<> struct floatBits_t<float> { using type = uint32_t; };
+		template<> struct floatBits_t<double> { using type = uint64_t; };
+
+		// Counts how many representable values apart two values are. Values of the same sign are as far
+		// apart as the difference of their magnitudes, and those of opposite sign the sum of them.
+		template<typename T> static uint64_t ulpDistance(const T result, const T expected) noexcept
+		{
+			using bits_t = typename floatBits_t<T>::type;
+			constexpr auto signBit{bits_t(bits_t{1} << (sizeof(bits_t) * 8U - 1U))};
+			bits_t resultBits{};
+			bits_t expectedBits{};
+			memcpy(&resultBits, &result, sizeof(T));
+			memcpy(&expectedBits, &expected, sizeof(T));
+			const uint64_t resultMagnitude{resultBits & bits_t(~signBit)};
+			const uint64_t expectedMagnitude{expectedBits & bits_t(~signBit)};
+			if ((resultBits ^ expectedBits) & signBit)
+				return resultMagnitude + expectedMagnitude;
+			return resultMagnitude > expectedMagnitude ? resultMagnitude - expectedMagnitude :
+				expectedMagnitude - resultMagnitude;
+		}
+
+		template<typename T> static bool withinUlps(const T result, const T expected, const uint64_t maxUlps) noexcept
+			{ return !std::isnan(result) && !std::isnan(expected) && ulpDistance(result, expected) <= maxUlps; }
+
+		// Values are within tolerance if they are equal, or differ by no more than the larger of the absolute
+		// tolerance and the relative tolerance scaled by the expected value. Infinities must be matched exactly.
+		template<typename T> static T allowedError(const T expected, const T relative, const T absolute) noexcept
+			{ return std::max(absolute, relative * std::fabs(expected)); }
+
+		template<typename T> static bool withinTolerance(const T result, const T expected, const T relative,
+			const T absolute) noexcept
+		{
+			const auto error{std::fabs(result - expected)};
+			return result == expected || (error <= allowedError(expected, relative, absolute) &&
+				error < std::numeric_limits<T>::infinity());
+		}
+
+		std::size_t countUlpFailures(const float *const result, const float *const expected, const std::size_t count,
+			const uint64_t maxUlps) noexcept
+		{
+			std::size_t failures{0};
+			std::size_t index{0};
+#if defined(__SSE2__)
+			// Distances between floats fit in 32 bits, which SSE2 can only compare as signed, so they
+			// are moved down by 2^31 to compare them as unsigned
+			const auto bias{_mm_set1_epi32(std::numeric_limits<int32_t>::min())};
+			const auto limit{_mm_xor_si128(_mm_set1_epi32(int32_t(uint32_t(std::min<uint64_t>(maxUlps, UINT32_MAX)))),
+				bias)};
+			const auto magnitudeMask{_mm_set1_epi32(std::numeric_limits<int32_t>::max())};
+			for (; index + 4U <= count; index += 4U)
+			{
+				const auto resultValues{_mm_loadu_ps(result + index)};
+				const auto expectedValues{_mm_loadu_ps(expected + index)};
+				const auto resultBits{_mm_castps_si128(resultValues)};
+				const auto expectedBits{_mm_castps_si128(expectedValues)};
+				const auto resultMagnitude{_mm_and_si128(resultBits, magnitudeMask)};
+				const auto expectedMagnitude{_mm_and_si128(expectedBits, magnitudeMask)};
+				const auto oppositeSigns{_mm_srai_epi32(_mm_xor_si128(resultBits, expectedBits), 31)};
+				const auto difference{_mm_sub_epi32(resultMagnitude, expectedMagnitude)};
+				const auto differenceSign{_mm_srai_epi32(difference, 31)};
+				const auto absoluteDifference{_mm_sub_epi32(_mm_xor_si128(difference, differenceSign), differenceSign)};
+				const auto sum{_mm_add_epi32(resultMagnitude, expectedMagnitude)};
+				const auto distance{_mm_or_si128(_mm_and_si128(oppositeSigns, sum),
+					_mm_andnot_si128(oppositeSigns, absoluteDifference))};
+				const auto tooFar{_mm_cmpgt_epi32(_mm_xor_si128(distance, bias), limit)};
+				const auto notANumber{_mm_castps_si128(_mm_cmpunord_ps(resultValues, expectedValues))};
+				failures += std::size_t(__builtin_popcount(uint32_t(_mm_movemask_ps(
+					_mm_castsi128_ps(_mm_or_si128(tooFar, notANumber))))));
+			}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+			// NEON compares unsigned, so the distances need no bias, and NaNs are found as they don't equal themselves
+			const auto limit{vdupq_n_u32(uint32_t(std::min<uint64_t>(maxUlps, UINT32_MAX)))};
+			const auto magnitudeMask{vdupq_n_u32(uint32_t(std::numeric_limits<int32_t>::max()))};
+			for (; index + 4U <= count; index += 4U)
+			{
+				const auto resultValues{vld1q_f32(result + index)};
+				const auto expectedValues{vld1q_f32(expected + index)};
+				const auto resultBits{vreinterpretq_u32_f32(resultValues)};
+				const auto expectedBits{vreinterpretq_u32_f32(expectedValues)};
+				const auto resultMagnitude{vandq_u32(resultBits, magnitudeMask)};
+				const auto expectedMagnitude{vandq_u32(expectedBits, magnitudeMask)};
+				const auto oppositeSigns{vreinterpretq_u32_s32(
+					vshrq_n_s32(vreinterpretq_s32_u32(veorq_u32(resultBits, expectedBits)), 31))};
+				const auto distance{vbslq_u32(oppositeSigns, vaddq_u32(resultMagnitude, expectedMagnitude),
+					vabdq_u32(resultMagnitude, expectedMagnitude))};
+				const auto numbers{vandq_u32(vceqq_f32(resultValues, resultValues),
+					vceqq_f32(expectedValues, expectedValues))};
+				const auto within{vandq_u32(vcleq_u32(distance, limit), numbers)};
+				failures += 4U - vaddvq_u32(vshrq_n_u32(within, 31));
+			}
+#endif
+			for (; index < count; ++index)
+				failures += withinUlps(result[index], expected[index], maxUlps) ? 0U : 1U;
+			return failures;
+		}
+
+		std::size_t countUlpFailures(const double *const result, const double *const expected, const std::size_t count,
+			const uint64_t maxUlps) noexcept
+		{
+			// SSE2 has no 64-bit compares, so this is left to the compiler to vectorise as it can
+			std::size_t failures{0};
+			for (std::size_t index{0}; index < count; ++index)
+				failures += withinUlps(result[index], expected[index], maxUlps) ? 0U : 1U;
+			return failures;
+		}
+
+		std::size_t countToleranceFailures(const float *const result, const float *const expected,
+			const std::size_t count, const double relative, const double absolute) noexcept
+		{
+			std::size_t failures{0};
+			std::size_t index{0};
+#if defined(__SSE2__)
+			const auto relativeValue{_mm_set1_ps(float(relative))};
+			const auto absoluteValue{_mm_set1_ps(float(absolute))};
+			const auto magnitudeMask{_mm_castsi128_ps(_mm_set1_epi32(std::numeric_limits<int32_t>::max()))};
+			const auto infinity{_mm_set1_ps(std::numeric_limits<float>::infinity())};
+			for (; index + 4U <= count; index += 4U)
+			{
+				const auto resultValues{_mm_loadu_ps(result + index)};
+				const auto expectedValues{_mm_loadu_ps(expected + index)};
+				const auto error{_mm_and_ps(_mm_sub_ps(resultValues, expectedValues), magnitudeMask)};
+				const auto allowed{_mm_max_ps(absoluteValue,
+					_mm_mul_ps(relativeValue, _mm_and_ps(expectedValues, magnitudeMask)))};
+				const auto within{_mm_or_ps(_mm_cmpeq_ps(resultValues, expectedValues),
+					_mm_and_ps(_mm_cmple_ps(error, allowed), _mm_cmplt_ps(error, infinity)))};
+				failures += 4U - std::size_t(__builtin_popcount(uint32_t(_mm_movemask_ps(within))));
+			}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+			const auto relativeValue{vdupq_n_f32(float(relative))};
+			const auto absoluteValue{vdupq_n_f32(float(absolute))};
+			const auto infinity{vdupq_n_f32(std::numeric_limits<float>::infinity())};
+			for (; index + 4U <= count; index += 4U)
+			{
+				const auto resultValues{vld1q_f32(result + index)};
+				const auto expectedValues{vld1q_f32(expected + index)};
+				const auto error{vabdq_f32(resultValues, expectedValues)};
+				const auto allowed{vmaxq_f32(absoluteValue, vmulq_f32(relativeValue, vabsq_f32(expectedValues)))};
+				const auto within{vorrq_u32(vceqq_f32(resultValues, expectedValues),
+					vandq_u32(vcleq_f32(error, allowed), vcltq_f32(error, infinity)))};
+				failures += 4U - vaddvq_u32(vshrq_n_u32(within, 31));
+			}
+#endif
+			for (; index < count; ++index)
+				failures += withinTolerance(result[index], expected[index], float(relative), float(absolute)) ? 0U : 1U;
+			return failures;
+		}
+
+		std::size_t countToleranceFailures(const double *const result, const double *const expected,
+			const std::size_t count, const double relative, const double absolute) noexcept
+		{
+			std::size_t failures{0};
+			std::size_t index{0};
+#if defined(__SSE2__)
+			const auto relativeValue{_mm_set1_pd(relative)};
+			const auto absoluteValue{_mm_set1_pd(absolute)};
+			const auto magnitudeMask{_mm_castsi128_pd(_mm_set1_epi64x(std::numeric_limits<int64_t>::max()))};
+			const auto infinity{_mm_set1_pd(std::numeric_limits<double>::infinity())};
+			for (; index + 2U <= count; index += 2U)
+			{
+				const auto resultValues{_mm_loadu_pd(result + index)};
+				const auto expectedValues{_mm_loadu_pd(expected + index)};
+				const auto error{_mm_and_pd(_mm_sub_pd(resultValues, expectedValues), magnitudeMask)};
+				const auto allowed{_mm_max_pd(absoluteValue,
+					_mm_mul_pd(relativeValue, _mm_and_pd(expectedValues, magnitudeMask)))};
+				const auto within{_mm_or_pd(_mm_cmpeq_pd(resultValues, expectedValues),
+					_mm_and_pd(_mm_cmple_pd(error, allowed), _mm_cmplt_pd(error, infinity)))};
+				failures += 2U - std::size_t(__builtin_popcount(uint32_t(_mm_movemask_pd(within))));
+			}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+			const auto relativeValue{vdupq_n_f64(relative)};
+			const auto absoluteValue{vdupq_n_f64(absolute)};
+			const auto infinity{vdupq_n_f64(std::numeric_limits<double>::infinity())};
+			for (; index + 2U <= count; index += 2U)
+			{
+				const auto resultValues{vld1q_f64(result + index)};
+				const auto expectedValues{vld1q_f64(expected + index)};
+				const auto error{vabdq_f64(resultValues, expectedValues)};
+				const auto allowed{vmaxq_f64(absoluteValue, vmulq_f64(relativeValue, vabsq_f64(expectedValues)))};
+				const auto within{vorrq_u64(vceqq_f64(resultValues, expectedValues),
+					vandq_u64(vcleq_f64(error, allowed), vcltq_f64(error, infinity)))};
+				failures += 2U - std::size_t(vaddvq_u64(vshrq_n_u64(within, 63)));
+			}
+#endif
+			for (; index < count; ++index)
+				failures += withinTolerance(result[index], expected[index], relative, absolute) ? 0U : 1U;
+			return failures;
+		}
+
+		// How the errors of the elements out of tolerance are spread, as multiples of the tolerance
+		struct errorSpread_t final
+		{
+			std::size_t failures{0};
+			std::size_t worst{0};
+			double worstRatio{0.0};
+			std::array<std::size_t, 5> buckets{};
+		};
+
+		static const std::array<const char *, 5> bucketNames
+		{{
+			"up to 2x the tolerance", "2x to 4x the tolerance", "4x to 16x the tolerance",
+			"16x to 256x the tolerance", "over 256x the tolerance, or not a number"
+		}};
+
+		template<typename T, typename ratio_t> static errorSpread_t spreadErrors(const T *const result,
+			const T *const expected, const std::size_t count, ratio_t &&ratioOf)
+		{
+			errorSpread_t spread{};
+			for (std::size_t index{0}; index < count; ++index)
+			{
+				double ratio{0.0};
+				if (!ratioOf(result[index], expected[index], ratio))
+					continue;
+				++spread.failures;
+				if (spread.failures == 1 || ratio > spread.worstRatio || std::isnan(ratio))
+				{
+					spread.worst = index;
+					spread.worstRatio = std::isnan(ratio) ? std::numeric_limits<double>::infinity() : ratio;
+				}
+				spread.buckets[ratio <= 2.0 ? 0 : ratio <= 4.0 ? 1 : ratio <= 16.0 ? 2 : ratio <= 256.0 ? 3 : 4]++;
+			}
+			return spread;
+		}
+
+		static void printSpread(const errorSpread_t &spread)
+		{
+			for (std::size_t bucket{0}; bucket < spread.buckets.size(); ++bucket)
+			{
+				if (!spread.buckets[bucket])
+					continue;
+				testPrintf("\t%zu %s %s", spread.buckets[bucket], spread.buckets[bucket] == 1 ? "element" : "elements",
+					bucketNames[bucket]);
+				newline();
+			}
+		}
+
+		// How many significant digits it takes to tell apart every value of the type
+		template<typename T> constexpr static int32_t valueDigits() noexcept
+			{ return std::numeric_limits<T>::max_digits10; }
+
+		template<typename T> [[noreturn]] static void ulpFailure(const T *const result, const T *const expected,
+			const std::size_t count, const uint64_t maxUlps)
+		{
+			const auto spread{spreadErrors(result, expected, count, [=](const T resultValue, const T expectedValue,
+				double &ratio) noexcept
+			{
+				if (withinUlps(resultValue, expectedValue, maxUlps))
+					return false;
+				const auto distance{ulpDistance(resultValue, expectedValue)};
+				ratio = std::isnan(resultValue) || std::isnan(expectedValue) || !maxUlps ?
+					std::numeric_limits<double>::infinity() : double(distance) / double(maxUlps);
+				return true;
+			})};
+			const auto index{spread.worst};
+			const auto distance{ulpDistance(result[index], expected[index])};
+			if (count == 1)
+				logResult(RESULT_FAILURE, "Assertion failure: expected %.*g, got %.*g, %" PRIu64 " ULPs apart with %"
+					PRIu64 " allowed", valueDigits<T>(), double(expected[0]), valueDigits<T>(), double(result[0]),
+					distance, maxUlps);
+			else
+			{
+				logResult(RESULT_FAILURE, "Assertion failure: %zu of %zu elements out of tolerance, worst at index %zu: "
+					"expected %.*g, got %.*g, %" PRIu64 " ULPs apart with %" PRIu64 " allowed", spread.failures, count,
+					index, valueDigits<T>(), double(expected[index]), valueDigits<T>(), double(result[index]), distance,
+					maxUlps);
+				printSpread(spread);
+			}
+			throw threadExit_t{1};
+		}
+
+		template<typename T> [[noreturn]] static void toleranceFailure(const T *const result, const T *const expected,
+			const std::size_t count, const T relative, const T absolute)
+		{
+			const auto spread{spreadErrors(result, expected, count, [=](const T resultValue, const T expectedValue,
+				double &ratio) noexcept
+			{
+				if (withinTolerance(resultValue, expectedValue, relative, absolute))
+					return false;
+				ratio = double(std::fabs(resultValue - expectedValue)) /
+					double(allowedError(expectedValue, relative, absolute));
+				return true;
+			})};
+			const auto index{spread.worst};
+			const auto error{std::fabs(result[index] - expected[index])};
+			const auto allowed{allowedError(expected[index], relative, absolute)};
+			if (count == 1)
+				logResult(RESULT_FAILURE, "Assertion failure: expected %.*g, got %.*g, off by %g with %g allowed",
+					valueDigits<T>(), double(expected[0]), valueDigits<T>(), double(result[0]), double(error),
+					double(allowed));
+			else
+			{
+				logResult(RESULT_FAILURE, "Assertion failure: %zu of %zu elements out of tolerance, worst at index %zu: "
+					"expected %.*g, got %.*g, off by %g with %g allowed", spread.failures, count, index,
+					valueDigits<T>(), double(expected[index]), valueDigits<T>(), double(result[index]), double(error),
+					double(allowed));
+				printSpread(spread);
+			}
+			throw threadExit_t{1};
+		}
+
+		void ulpFailure(const float *const result, const float *const expected, const std::size_t count,
+			const uint64_t maxUlps)
+			{ ulpFailure<float>(result, expected, count, maxUlps); }
+
+		void ulpFailure(const double *const result, const double *const expected, const std::size_t count,
+			const uint64_t maxUlps)
+			{ ulpFailure<double>(result, expected, count, maxUlps); }
+
+		void toleranceFailure(const float *const result, const float *const expected, const std::size_t count,
+			const double relative, const double absolute)
+			{ toleranceFailure<float>(result, expected, count, float(relative), float(absolute)); }
+
+		void toleranceFailure(const double *const result, const double *const expected, const std::size_t count,
+			const double relative, const double absolute)
+			{ toleranceFailure<double>(result, expected, count, relative, absolute); }
+	} // namespace internal
+} // namespace crunch
@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <substrate/utility>
+#include "history.hxx"
+
+namespace crunch
+{
+	testHistory_t *testHistory{nullptr};
+	static thread_local const char *contextLibrary{nullptr};
+	static thread_local const char *contextSuite{nullptr};
+
+	// Identifies the format of the history file, which is otherwise one tab separated record per line:
+	// a test record with the test's duration for every test, a failed record for each that failed, and
+	// a library record for each file a library that passed was made up of
+	constexpr static const char *historyHeader{"crunch++ history 1"};
+
+	static bool readLine(FILE *const file, std::string &line)
+	{
+		line.clear();
+		int chr{};
+		while ((chr = fgetc(file)) != EOF && chr != '\n')
+			line += char(chr);
+		return chr != EOF || !line.empty();
+	}
+
+	static std::vector<std::string> splitFields(const std::string &line)
+	{
+		std::vector<std::string> fields{};
+		std::size_t begin{0};
+		while (true)
+		{
+			const auto end{line.find('\t', begin)};
+			fields.emplace_back(line.substr(begin, end - begin));
+			if (end == std::string::npos)
+				return fields;
+			begin = end + 1;
+		}
+	}
+
+	std::string testHistory_t::key(const char *const library, const char *const suite, const char *const test)
+	{
+		std::string result{library};
+		result += '\t';
+		result += suite;
+		result += '\t';
+		result += test;
+		return result;
+	}
+
+	testHistory_t::testHistory_t(std::string fileName) : fileName_{std::move(fileName)}
+	{
+		// A missing or unreadable history just means we start afresh
+		auto *const file{fopen(fileName_.c_str(), "rb")};
+		if (!file)
+			return;
+		std::string line{};
+		if (readLine(file, line) && line == historyHeader)
+		{
+			while (readLine(file, line))
+			{
+				const auto fields{splitFields(line)};
+				if (fields.size() == 5 && fields[0] == "test")
+					durations[key(fields[1].c_str(), fields[2].c_str(), fields[3].c_str())] =
+						std::strtoull(fields[4].c_str(), nullptr, 10);
+				else if (fields.size() == 4 && fields[0] == "failed")
+					failures.insert(key(fields[1].c_str(), fields[2].c_str(), fields[3].c_str()));
+				else if (fields.size() == 4 && fields[0] == "library")
+					libraries[fields[1]].push_back({fields[2], std::strtoull(fields[3].c_str(), nullptr, 16)});
+			}
+		}
+		fclose(file);
+	}
+
+	bool testHistory_t::save() const
+	{
+		// Write the new history alongside the old and swap it in, so an interrupted run can't leave a torn file
+		const auto tempName{fileName_ + ".new"};
+		auto *const file{fopen(tempName.c_str(), "wb")};
+		if (!file)
+			return false;
+		bool ok{fprintf(file, "%s\n", historyHeader) > 0};
+		{
+			std::lock_guard<std::mutex> guard{lock};
+			for (const auto &entry : durations)
+				ok &= fprintf(file, "test\t%s\t%" PRIu64 "\n", entry.first.c_str(), entry.second) > 0;
+			for (const auto &entry : failures)
+				ok &= fprintf(file, "failed\t%s\n", entry.c_str()) > 0;
+			for (const auto &library : libraries)
+			{
+				for (const auto &entry : library.second)
+					ok &= fprintf(file, "library\t%s\t%s\t%016" PRIx64 "\n", library.first.c_str(),
+						entry.path.c_str(), entry.hash) > 0;
+			}
+		}
+		ok &= fclose(file) == 0;
+#ifdef _WIN32
+		// Windows won't rename over an existing file
+		remove(fileName_.c_str());
+#endif
+		if (!ok || rename(tempName.c_str(), fileName_.c_str()))
+		{
+			remove(tempName.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	uint64_t testHistory_t::duration(const char *const library, const char *const suite,
+		const char *const test) const
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		const auto entry{durations.find(key(library, suite, test))};
+		return entry == durations.end() ? unknownDuration : entry->second;
+	}
+
+	uint64_t testHistory_t::libraryDuration(const char *const library) const
+	{
+		std::string prefix{library};
+		prefix += '\t';
+		uint64_t total{0};
+		std::lock_guard<std::mutex> guard{lock};
+		for (const auto &entry : durations)
+		{
+			if (entry.first.compare(0, prefix.length(), prefix) == 0)
+				total += entry.second;
+		}
+		return total ? total : unknownDuration;
+	}
+
+	void testHistory_t::record(const char *const library, const char *const suite, const char *const test,
+		const uint64_t duration)
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		durations[key(library, suite, test)] = duration;
+	}
+
+	bool testHistory_t::failed(const char *const library, const char *const suite, const char *const test) const
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		return failures.count(key(library, suite, test)) != 0;
+	}
+
+	bool testHistory_t::anyFailed(const char *const library, const char *const suite) const
+	{
+		std::string prefix{library};
+		prefix += '\t';
+		if (suite)
+		{
+			prefix += suite;
+			prefix += '\t';
+		}
+		std::lock_guard<std::mutex> guard{lock};
+		return std::any_of(failures.begin(), failures.end(),
+			[&](const std::string &entry) { return entry.compare(0, prefix.length(), prefix) == 0; });
+	}
+
+	void testHistory_t::recordOutcome(const char *const library, const char *const suite, const char *const test,
+		const bool failed)
+	{
+		auto entry{key(library, suite, test)};
+		std::lock_guard<std::mutex> guard{lock};
+		if (failed)
+			failures.insert(std::move(entry));
+		else
+			failures.erase(entry);
+	}
+
+	std::vector<libraryFile_t> testHistory_t::libraryFiles(const char *const library) const
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		const auto entry{libraries.find(library)};
+		return entry == libraries.end() ? std::vector<libraryFile_t>{} : entry->second;
+	}
+
+	void testHistory_t::recordLibrary(const char *const library, std::vector<libraryFile_t> files)
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		libraries[library] = std::move(files);
+	}
+
+	void historyContext(const char *const library, const char *const suite) noexcept
+	{
+		contextLibrary = library;
+		contextSuite = suite;
+	}
+
+	const char *currentLibrary() noexcept { return contextLibrary; }
+	const char *currentSuite() noexcept { return contextSuite; }
+
+	std::vector<std::size_t> scheduleOrder(const std::vector<internal::cxxTest> &tests)
+	{
+		std::vector<std::size_t> order(tests.size());
+		for (std::size_t i{0}; i < order.size(); ++i)
+			order[i] = i;
+		if (!testHistory || !contextLibrary || !contextSuite)
+			return order;
+
+		std::vector<uint64_t> expected(tests.size());
+		for (std::size_t i{0}; i < tests.size(); ++i)
+			expected[i] = testHistory->duration(contextLibrary, contextSuite, tests[i].name());
+		// Longest first, otherwise keeping to registration order
+		std::stable_sort(order.begin(), order.end(),
+			[&](const std::size_t a, const std::size_t b) { return expected[a] > expected[b]; });
+		return order;
+	}
+
+	void failuresFirst(std::vector<internal::cxxTest> &tests)
+	{
+		if (!testHistory || !contextLibrary || !contextSuite)
+			return;
+		std::stable_partition(tests.begin(), tests.end(), [](const internal::cxxTest &test)
+			{ return testHistory->failed(contextLibrary, contextSuite, test.name()); });
+	}
+
+	void recordDuration(const internal::cxxTest &test, const uint64_t duration)
+	{
+		if (testHistory && contextLibrary && contextSuite)
+			testHistory->record(contextLibrary, contextSuite, test.name(), duration);
+	}
+
+	void recordOutcome(const internal::cxxTest &test, const bool failed)
+	{
+		if (testHistory && contextLibrary && contextSuite)
+			testHistory->recordOutcome(contextLibrary, contextSuite, test.name(), failed);
+	}
+
+	std::string qualifiedName(const internal::cxxTest &test)
+	{
+		if (!contextSuite)
+			return test.name();
+		// Decoding the test class's name is costly, so only do so when the class being run changes
+		static thread_local std::string suite{};
+		static thread_local std::string suiteName{};
+		if (suite != contextSuite)
+		{
+			suite = contextSuite;
+			suiteName = substrate::decode_typename(contextSuite);
+		}
+		std::string result{suiteName};
+		result += "::";
+		result += test.name();
+		return result;
+	}
+} // namespace crunch
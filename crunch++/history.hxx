@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef HISTORY__HXX
+#define HISTORY__HXX
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// A file a test library was made up of when it last ran, and the hash of its contents at the time
+	struct libraryFile_t final
+	{
+		std::string path;
+		uint64_t hash;
+	};
+
+	// A small on-disk database of how long each test took when it last ran and whether it failed,
+	// keyed by test library, test class and test name, used to schedule the tests that failed last
+	// time first, and then the longest running tests.
+	struct testHistory_t final
+	{
+	private:
+		std::string fileName_;
+		std::unordered_map<std::string, uint64_t> durations{};
+		std::unordered_set<std::string> failures{};
+		std::unordered_map<std::string, std::vector<libraryFile_t>> libraries{};
+		mutable std::mutex lock{};
+
+		static std::string key(const char *library, const char *suite, const char *test);
+
+	public:
+		// Stands in for the duration of a test that has no history, so such tests are run first
+		constexpr static uint64_t unknownDuration{UINT64_MAX};
+
+		CRUNCH_VIS testHistory_t(std::string fileName);
+		testHistory_t(const testHistory_t &) = delete;
+		testHistory_t(testHistory_t &&) = delete;
+		~testHistory_t() noexcept = default;
+		testHistory_t &operator =(const testHistory_t &) = delete;
+		testHistory_t &operator =(testHistory_t &&) = delete;
+
+		CRUNCH_VIS bool save() const;
+		// Durations are all in nanoseconds
+		uint64_t duration(const char *library, const char *suite, const char *test) const;
+		CRUNCH_VIS uint64_t libraryDuration(const char *library) const;
+		void record(const char *library, const char *suite, const char *test, uint64_t duration);
+		bool failed(const char *library, const char *suite, const char *test) const;
+		// Whether any test in the library, or in the given test class of it, failed when last run
+		CRUNCH_VIS bool anyFailed(const char *library, const char *suite = nullptr) const;
+		void recordOutcome(const char *library, const char *suite, const char *test, bool failed);
+		// The files the library and its dependencies were loaded from when all its tests last ran
+		std::vector<libraryFile_t> libraryFiles(const char *library) const;
+		void recordLibrary(const char *library, std::vector<libraryFile_t> files);
+	};
+
+	// The history the runner loaded for this run, or nullptr if it wasn't asked to keep one
+	CRUNCHpp_API testHistory_t *testHistory;
+	// Sets which library and test class the calling thread is running tests for
+	CRUNCHpp_API void historyContext(const char *library, const char *suite) noexcept;
+	// The library and test class the calling thread is running tests for, where known
+	const char *currentLibrary() noexcept;
+	const char *currentSuite() noexcept;
+
+	// Returns the order in which to start tests so the longest expected go first
+	std::vector<std::size_t> scheduleOrder(const std::vector<internal::cxxTest> &tests);
+	// Moves the tests that failed when last run to the front, otherwise keeping to registration order
+	void failuresFirst(std::vector<internal::cxxTest> &tests);
+	void recordDuration(const internal::cxxTest &test, uint64_t duration);
+	void recordOutcome(const internal::cxxTest &test, bool failed);
+	// Names the test as Suite::test, with the name of the test class decoded, where the class being run is known
+	std::string qualifiedName(const internal::cxxTest &test);
+
+	inline uint64_t nanosecondsSince(const std::chrono::steady_clock::time_point start) noexcept
+	{
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count());
+	}
+} // namespace crunch
+
+#endif /*HISTORY__HXX*/
@@ -0,0 +1,517 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+#include "isolation.hxx"
+#include "core.hxx"
+#include "logger.hxx"
+#include "history.hxx"
+#include "backtrace.hxx"
+#include "capture.hxx"
+
+namespace crunch
+{
+	bool isolateTests = false;
+	uint64_t testTimeout = 0;
+	uint64_t suiteTimeout = 0;
+
+	// Stands in for a limit a suite hasn't overridden
+	constexpr static uint64_t noOverride{UINT64_MAX};
+	// The limits suites have set from registerTests(), kept out of testsuite itself to preserve its layout
+	static std::unordered_map<const testsuite *, isolatedTimeouts_t> timeoutOverrides{};
+	static std::mutex timeoutOverridesLock{};
+
+	static uint64_t secondsToNanoseconds(const double seconds) noexcept
+		{ return seconds > 0.0 ? uint64_t(seconds * 1e9) : 0U; }
+
+	static isolatedTimeouts_t &overridesFor(const testsuite &suite)
+	{
+		const auto entry{timeoutOverrides.find(&suite)};
+		if (entry != timeoutOverrides.end())
+			return entry->second;
+		return timeoutOverrides[&suite] = {noOverride, noOverride};
+	}
+
+	isolatedTimeouts_t timeoutsFor(const testsuite &suite)
+	{
+		std::lock_guard<std::mutex> lock{timeoutOverridesLock};
+		const auto entry{timeoutOverrides.find(&suite)};
+		if (entry == timeoutOverrides.end())
+			return {testTimeout, suiteTimeout};
+		const auto &overrides{entry->second};
+		return
+		{
+			overrides.test == noOverride ? testTimeout : overrides.test,
+			overrides.suite == noOverride ? suiteTimeout : overrides.suite
+		};
+	}
+
+	void forgetTimeouts(const testsuite &suite) noexcept
+	{
+		std::lock_guard<std::mutex> lock{timeoutOverridesLock};
+		timeoutOverrides.erase(&suite);
+	}
+
+#ifndef _WIN32
+	// What a worker sends back to the runner after each test, followed by outputLength bytes of output
+	// and messageLength bytes of the test's report message
+	struct isolatedFrame_t final
+	{
+		uint64_t index;
+		uint64_t wallTime;
+		uint64_t cpuTime;
+		int32_t result;
+		uint32_t passes;
+		uint32_t failures;
+		uint32_t outputLength;
+		uint32_t messageLength;
+		bool skipped;
+	};
+
+	struct isolatedWorker_t final
+	{
+		pid_t pid{-1};
+		int fd{-1};
+		std::size_t test{SIZE_MAX};
+		std::chrono::steady_clock::time_point started{};
+		// When the test must be finished by, or once signalled, when the worker must have reported by
+		std::chrono::steady_clock::time_point deadline{};
+		bool signalled{false};
+
+		bool busy() const noexcept { return test != SIZE_MAX; }
+	};
+
+	static bool readExact(const int fd, void *const buffer, const std::size_t length) noexcept
+	{
+		auto *const data{static_cast<char *>(buffer)};
+		std::size_t offset{0};
+		while (offset < length)
+		{
+			const auto result{read(fd, data + offset, length - offset)};
+			if (result < 0 && errno == EINTR)
+				continue;
+			if (result <= 0)
+				return false;
+			offset += std::size_t(result);
+		}
+		return true;
+	}
+
+	static bool writeExact(const int fd, const void *const buffer, const std::size_t length) noexcept
+	{
+		const auto *const data{static_cast<const char *>(buffer)};
+		std::size_t offset{0};
+		while (offset < length)
+		{
+			const auto result{write(fd, data + offset, length - offset)};
+			if (result < 0 && errno == EINTR)
+				continue;
+			if (result <= 0)
+				return false;
+			offset += std::size_t(result);
+		}
+		return true;
+	}
+
+	// The signal the runner sends a worker whose test has overrun its time limit
+	constexpr static int watchdogSignal{SIGUSR1};
+	// How long a signalled worker has to report its test's stack trace before being killed outright
+	constexpr static std::chrono::seconds watchdogGrace{2};
+
+	// What the watchdog handler needs to know of the test a worker is running
+	static int workerFD{-1};
+	static pthread_t workerThread{};
+	static uint64_t workerTest{0};
+	static std::string *workerOutput{nullptr};
+	static uint32_t workerPasses{0};
+	static uint32_t workerFailures{0};
+
+	static void watchdogHandler(const int) noexcept
+	{
+		// The stack trace must be of the test, so pass the signal on if it landed on another thread
+		if (!pthread_equal(pthread_self(), workerThread))
+		{
+			pthread_kill(workerThread, watchdogSignal);
+			return;
+		}
+		// None of this is async-signal-safe, but should it deadlock, the runner kills us at the end of our grace period
+		captureOutput(nullptr);
+		auto &output{*workerOutput};
+		if (!output.empty() && output.back() != '\n')
+			output += '\n';
+		output += formatCapture(endCapture());
+		output += formatBacktrace();
+		const auto &report{threadReport()};
+		const isolatedFrame_t frame{workerTest, 0, 0, isolatedTimedOut, results.passes - workerPasses,
+			results.failures - workerFailures, uint32_t(output.length()), uint32_t(report.message.length()), report.skipped};
+		if (writeExact(workerFD, &frame, sizeof(frame)) && writeExact(workerFD, output.data(), output.length()))
+			writeExact(workerFD, report.message.data(), report.message.length());
+		_exit(0);
+	}
+
+	[[noreturn]] static void workerMain(const int fd, const std::function<int32_t (std::size_t)> &runTest) noexcept
+	{
+		// Let crashes kill the worker outright so the runner sees the signal that caused them
+		for (const auto sig : {SIGABRT, SIGSEGV, SIGILL, SIGFPE, SIGBUS, SIGPIPE})
+			signal(sig, SIG_DFL); // NOLINT(cert-err33-c)
+		workerFD = fd;
+		workerThread = pthread_self();
+		struct sigaction watchdog{};
+		watchdog.sa_handler = watchdogHandler;
+		sigemptyset(&watchdog.sa_mask);
+		sigaction(watchdogSignal, &watchdog, nullptr);
+
+		uint64_t index{};
+		while (readExact(fd, &index, sizeof(index)))
+		{
+			std::string output{};
+			const uint32_t passesBefore{results.passes};
+			const uint32_t failuresBefore{results.failures};
+			workerTest = index;
+			workerOutput = &output;
+			workerPasses = passesBefore;
+			workerFailures = failuresBefore;
+			int32_t result{};
+			captureOutput(&output);
+			lastTestTiming() = {};
+			threadReport() = {};
+			try
+				{ result = runTest(std::size_t(index)); }
+			catch (...)
+				{ result = isolatedErrorOutsideTest; }
+			const auto timing{lastTestTiming()};
+			captureOutput(nullptr);
+
+			const auto &report{threadReport()};
+			const isolatedFrame_t frame{index, timing.wallTime, timing.cpuTime, result, results.passes - passesBefore,
+				results.failures - failuresBefore, uint32_t(output.length()), uint32_t(report.message.length()), report.skipped};
+			if (!writeExact(fd, &frame, sizeof(frame)) ||
+				!writeExact(fd, output.data(), output.length()) ||
+				!writeExact(fd, report.message.data(), report.message.length()))
+				break;
+		}
+		_exit(0);
+	}
+
+	static bool spawnWorker(isolatedWorker_t &worker, const std::vector<isolatedWorker_t> &workers,
+		const std::function<int32_t (std::size_t)> &runTest) noexcept
+	{
+		int fds[2]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+			return false;
+		// Output still buffered here would otherwise be written a second time should the worker flush it
+		fflush(nullptr);
+		const auto pid{fork()};
+		if (pid == -1)
+		{
+			close(fds[0]);
+			close(fds[1]);
+			return false;
+		}
+		else if (pid == 0)
+		{
+			// Drop our copies of the other workers' connections so they see EOF when the runner closes them
+			close(fds[0]);
+			for (const auto &other : workers)
+			{
+				if (other.fd != -1)
+					close(other.fd);
+			}
+			workerMain(fds[1], runTest);
+		}
+		close(fds[1]);
+		worker.pid = pid;
+		worker.fd = fds[0];
+		worker.test = SIZE_MAX;
+		worker.signalled = false;
+		return true;
+	}
+
+	static int reapWorker(isolatedWorker_t &worker, const bool kill) noexcept
+	{
+		int status{0};
+		if (worker.fd != -1)
+			close(worker.fd);
+		if (worker.pid != -1)
+		{
+			if (kill)
+				::kill(worker.pid, SIGKILL);
+			while (waitpid(worker.pid, &status, 0) == -1 && errno == EINTR)
+				continue;
+		}
+		worker.pid = -1;
+		worker.fd = -1;
+		return status;
+	}
+
+	// Works out how long poll() may wait before the next deadline passes, or -1 if there is none
+	static int pollTimeout(const std::vector<isolatedWorker_t> &workers,
+		const std::chrono::steady_clock::time_point suiteDeadline)
+	{
+		auto deadline{suiteDeadline};
+		for (const auto &worker : workers)
+		{
+			if (worker.busy())
+				deadline = std::min(deadline, worker.deadline);
+		}
+		if (deadline == std::chrono::steady_clock::time_point::max())
+			return -1;
+		const auto remaining{std::chrono::duration_cast<std::chrono::milliseconds>(
+			deadline - std::chrono::steady_clock::now()).count()};
+		// Round up so we don't wake just short of the deadline and spin
+		return int(std::max<decltype(remaining)>(std::min<decltype(remaining)>(remaining + 1, INT32_MAX), 0));
+	}
+
+	bool runIsolated(std::vector<isolatedResult_t> &results, const std::vector<std::size_t> &order,
+		const std::size_t jobs, const isolatedTimeouts_t &timeouts, const std::function<int32_t (std::size_t)> &runTest,
+		const std::function<void (std::size_t)> &onComplete)
+	{
+		const auto count{results.size()};
+		std::vector<isolatedWorker_t> workers(std::max<std::size_t>(std::min(jobs, count), 1U));
+		std::size_t running{0};
+		for (auto &worker : workers)
+		{
+			if (spawnWorker(worker, workers, runTest))
+				++running;
+		}
+		if (!running)
+			return false;
+
+		// Writing to a worker that has just died must not take the runner down with it
+		const auto pipeHandler{signal(SIGPIPE, SIG_IGN)}; // NOLINT(cert-err33-c)
+		const auto shutdown = [&](const bool kill) noexcept
+		{
+			for (auto &worker : workers)
+				reapWorker(worker, kill);
+			signal(SIGPIPE, pipeHandler); // NOLINT(cert-err33-c)
+		};
+		std::size_t remaining{count};
+		std::size_t nextTest{0};
+		const auto now = []() noexcept { return std::chrono::steady_clock::now(); };
+		const auto suiteDeadline{timeouts.suite ? now() + std::chrono::nanoseconds{timeouts.suite} :
+			std::chrono::steady_clock::time_point::max()};
+		bool suiteExpired{false};
+
+		// Replace a worker, as it died or can't be trusted with another test
+		const auto replace = [&](isolatedWorker_t &worker) noexcept
+		{
+			if (!spawnWorker(worker, workers, runTest))
+				--running;
+		};
+
+		// A worker died - record that against the test it was running and fork a replacement. If we'd
+		// signalled it over its test overrunning, its death is that test timing out
+		const auto crashed = [&](isolatedWorker_t &worker)
+		{
+			const auto index{worker.test};
+			const auto timedOut{worker.signalled};
+			// All we can know of a test that crashed is how long it ran for by the wall clock
+			const testTiming_t timing{nanosecondsSince(worker.started), 0};
+			const auto status{reapWorker(worker, true)};
+			replace(worker);
+			if (index != SIZE_MAX)
+			{
+				auto &result{results[index]};
+				if (timedOut)
+					result.result = isolatedTimedOut;
+				else
+				{
+					result.crashed = true;
+					result.waitStatus = status;
+				}
+				result.timing = timing;
+				result.complete = true;
+				--remaining;
+				onComplete(index);
+			}
+		};
+
+		// Signal the workers whose tests have overrun, and kill those that have not reported back in time
+		const auto watchdog = [&]()
+		{
+			const auto time{now()};
+			if (!suiteExpired && time >= suiteDeadline)
+			{
+				// Everything still running is out of time, and nothing more gets started
+				suiteExpired = true;
+				for (auto &worker : workers)
+				{
+					if (worker.busy() && !worker.signalled)
+						worker.deadline = time;
+				}
+				while (nextTest < count)
+				{
+					const auto index{order[nextTest++]};
+					results[index].result = isolatedSuiteTimedOut;
+					results[index].complete = true;
+					--remaining;
+					onComplete(index);
+				}
+			}
+			for (auto &worker : workers)
+			{
+				if (!worker.busy() || time < worker.deadline)
+					continue;
+				if (worker.signalled)
+					crashed(worker);
+				else
+				{
+					kill(worker.pid, watchdogSignal);
+					worker.signalled = true;
+					worker.deadline = time + watchdogGrace;
+				}
+			}
+		};
+
+		try
+		{
+			std::vector<pollfd> pollFDs{};
+			pollFDs.reserve(workers.size());
+			while (remaining)
+			{
+				if (!running)
+				{
+					testPrintf("Could not start a worker process to run the remaining tests in");
+					newline();
+					echoAborted();
+				}
+				// Once the run has failed enough, leave the tests yet to start unrun
+				if (failureLimitReached() && nextTest < count)
+				{
+					while (nextTest < count)
+					{
+						const auto index{order[nextTest++]};
+						results[index].result = isolatedNotRun;
+						results[index].complete = true;
+						--remaining;
+						onComplete(index);
+					}
+					continue;
+				}
+				// Hand a test to each idle worker
+				for (auto &worker : workers)
+				{
+					if (worker.fd == -1 || worker.busy() || nextTest == count)
+						continue;
+					worker.test = order[nextTest++];
+					worker.started = now();
+					worker.deadline = timeouts.test ? worker.started + std::chrono::nanoseconds{timeouts.test} :
+						std::chrono::steady_clock::time_point::max();
+					const uint64_t index{worker.test};
+					if (!writeExact(worker.fd, &index, sizeof(index)))
+						crashed(worker);
+				}
+
+				pollFDs.clear();
+				for (const auto &worker : workers)
+				{
+					if (worker.busy())
+						pollFDs.push_back({worker.fd, POLLIN, 0});
+				}
+				if (poll(pollFDs.data(), pollFDs.size(), pollTimeout(workers, suiteExpired ?
+					std::chrono::steady_clock::time_point::max() : suiteDeadline)) == -1)
+				{
+					if (errno == EINTR)
+						continue;
+					testPrintf("Lost contact with the worker processes running the tests");
+					newline();
+					echoAborted();
+				}
+
+				for (auto &worker : workers)
+				{
+					if (!worker.busy())
+						continue;
+					const auto pollFD{std::find_if(pollFDs.begin(), pollFDs.end(),
+						[&](const pollfd &entry) { return entry.fd == worker.fd; })};
+					if (pollFD == pollFDs.end() || !pollFD->revents)
+						continue;
+
+					isolatedFrame_t frame{};
+					if (!readExact(worker.fd, &frame, sizeof(frame)) || frame.index != worker.test)
+					{
+						crashed(worker);
+						continue;
+					}
+					auto &result{results[worker.test]};
+					result.output.resize(frame.outputLength);
+					result.report.message.resize(frame.messageLength);
+					if (!readExact(worker.fd, &result.output[0], frame.outputLength) ||
+						!readExact(worker.fd, &result.report.message[0], frame.messageLength))
+					{
+						result.output.clear();
+						result.report.message.clear();
+						crashed(worker);
+						continue;
+					}
+					result.report.skipped = frame.skipped;
+					result.result = frame.result;
+					result.failures = frame.failures;
+					// A test that timed out never got to take its own timing
+					result.timing = frame.result == isolatedTimedOut ?
+						testTiming_t{nanosecondsSince(worker.started), 0} : testTiming_t{frame.wallTime, frame.cpuTime};
+					result.complete = true;
+					crunch::results.passes += frame.passes;
+					crunch::results.failures += frame.failures;
+					worker.test = SIZE_MAX;
+					// A worker we've signalled is either exiting or about to be interrupted, so start afresh
+					if (worker.signalled)
+					{
+						reapWorker(worker, true);
+						replace(worker);
+					}
+					--remaining;
+					onComplete(std::size_t(frame.index));
+				}
+				watchdog();
+			}
+		}
+		catch (...)
+		{
+			shutdown(true);
+			throw;
+		}
+		shutdown(false);
+		return true;
+	}
+
+	void logCrash(const int waitStatus)
+	{
+		if (WIFSIGNALED(waitStatus))
+			logResult(RESULT_FAILURE, "Failure: Test crashed with signal %d (%s)", WTERMSIG(waitStatus),
+				strsignal(WTERMSIG(waitStatus)));
+		else
+			logResult(RESULT_FAILURE, "Failure: Test exited unexpectedly with status %d", WEXITSTATUS(waitStatus));
+	}
+#else
+	bool runIsolated(std::vector<isolatedResult_t> &, const std::vector<std::size_t> &, const std::size_t,
+		const isolatedTimeouts_t &, const std::function<int32_t (std::size_t)> &,
+		const std::function<void (std::size_t)> &)
+		{ return false; }
+
+	void logCrash(const int) { }
+#endif
+} // namespace crunch
+
+void testsuite::setTestTimeout(const double seconds)
+{
+	std::lock_guard<std::mutex> lock{crunch::timeoutOverridesLock};
+	crunch::overridesFor(*this).test = crunch::secondsToNanoseconds(seconds);
+}
+
+void testsuite::setSuiteTimeout(const double seconds)
+{
+	std::lock_guard<std::mutex> lock{crunch::timeoutOverridesLock};
+	crunch::overridesFor(*this).suite = crunch::secondsToNanoseconds(seconds);
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef ISOLATION__HXX
+#define ISOLATION__HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "crunch++.h"
+#include "timing.hxx"
+#include "reporter.hxx"
+
+namespace crunch
+{
+	// The outcome of a test run in an isolated worker process, as seen by the runner
+	struct isolatedResult_t final
+	{
+		std::string output{};
+		int32_t result{0};
+		// How many failures the test logged
+		uint32_t failures{0};
+		testReport_t report{};
+		testTiming_t timing{};
+		// Set along with waitStatus if the worker died while running the test
+		bool crashed{false};
+		int waitStatus{0};
+		bool complete{false};
+	};
+
+	// Results other than a test's own that a worker can report
+	constexpr static int32_t isolatedErrorOutsideTest{-1};
+	// The test overran its time limit and was stopped
+	constexpr static int32_t isolatedTimedOut{-2};
+	// The suite ran out of time before the test could be started
+	constexpr static int32_t isolatedSuiteTimedOut{-3};
+	// The test was never started as the run had reached its failure limit
+	constexpr static int32_t isolatedNotRun{-4};
+
+	// Time limits in nanoseconds for each test and for a whole suite, with 0 meaning no limit
+	struct isolatedTimeouts_t final
+	{
+		uint64_t test;
+		uint64_t suite;
+	};
+
+	CRUNCHpp_API bool isolateTests;
+	// The time limits given on the command line, which suites may override from registerTests()
+	CRUNCHpp_API uint64_t testTimeout;
+	CRUNCHpp_API uint64_t suiteTimeout;
+
+	// Returns the time limits that apply to the given suite's tests
+	isolatedTimeouts_t timeoutsFor(const testsuite &suite);
+	void forgetTimeouts(const testsuite &suite) noexcept;
+
+	// Runs the tests [0, results.size()), starting them in the given order, in a pool of up to
+	// jobs worker processes forked from the calling one, so each worker already has the test
+	// library loaded and its tests registered. runTest is only ever called in a worker.
+	// onComplete is called in the caller each time a result arrives, and may throw to end the run.
+	// A worker that crashes is replaced by forking a fresh one, as is one whose test overruns its
+	// time limit once it has reported the test's stack trace. Returns false if no workers could be started.
+	bool runIsolated(std::vector<isolatedResult_t> &results, const std::vector<std::size_t> &order, std::size_t jobs,
+		const isolatedTimeouts_t &timeouts, const std::function<int32_t (std::size_t)> &runTest,
+		const std::function<void (std::size_t)> &onComplete);
+	// Logs the failure of a test whose worker died with the given wait status
+	void logCrash(int waitStatus);
+} // namespace crunch
+
+#endif /*ISOLATION__HXX*/
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <link.h>
+#endif
+#include "libraryCache.hxx"
+#include "history.hxx"
+
+namespace crunch
+{
+	bool skipUnchanged{false};
+	std::atomic<uint32_t> cachedLibraries{0};
+#if !defined(_WIN32) && !defined(__APPLE__)
+	const bool libraryCacheSupported{true};
+#else
+	const bool libraryCacheSupported{false};
+#endif
+
+	// The hashes of the files seen so far this run, as the same system libraries underpin every test library
+	static std::unordered_map<std::string, uint64_t> fileHashes{};
+	static std::unordered_set<std::string> testLibraries{};
+	static std::mutex cacheLock{};
+
+	// FNV-1a over the file's contents. Returns false if the file could not be read
+	static bool hashFile(const std::string &path, uint64_t &hash)
+	{
+		{
+			std::lock_guard<std::mutex> lock{cacheLock};
+			const auto entry{fileHashes.find(path)};
+			if (entry != fileHashes.end())
+			{
+				hash = entry->second;
+				return true;
+			}
+		}
+		auto *const file{fopen(path.c_str(), "rb")};
+		if (!file)
+			return false;
+		hash = UINT64_C(0xcbf29ce484222325);
+		std::array<uint8_t, 65536> buffer{};
+		std::size_t count{};
+		while ((count = fread(buffer.data(), 1, buffer.size(), file)) != 0)
+		{
+			for (std::size_t i{0}; i < count; ++i)
+			{
+				hash ^= buffer[i];
+				hash *= UINT64_C(0x100000001b3);
+			}
+		}
+		const bool ok{!ferror(file)};
+		fclose(file);
+		if (ok)
+		{
+			std::lock_guard<std::mutex> lock{cacheLock};
+			fileHashes[path] = hash;
+		}
+		return ok;
+	}
+
+	bool libraryUnchanged(const char *const library)
+	{
+		if (!skipUnchanged || !testHistory || testHistory->anyFailed(library))
+			return false;
+		const auto files{testHistory->libraryFiles(library)};
+		if (files.empty())
+			return false;
+		for (const auto &file : files)
+		{
+			uint64_t hash{};
+			if (!hashFile(file.path, hash) || hash != file.hash)
+				return false;
+		}
+		return true;
+	}
+
+	void forgetFileHashes()
+	{
+		std::lock_guard<std::mutex> lock{cacheLock};
+		fileHashes.clear();
+	}
+
+	void noteTestLibrary(const char *const path)
+	{
+		std::lock_guard<std::mutex> lock{cacheLock};
+		testLibraries.emplace(path);
+	}
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+	static int collectObject(dl_phdr_info *const info, const std::size_t, void *const data)
+	{
+		auto &paths{*static_cast<std::vector<std::string> *>(data)};
+		// Skip the runner itself, which has no name, and the vDSO, which has no file behind it
+		if (info->dlpi_name && strchr(info->dlpi_name, '/'))
+			paths.emplace_back(info->dlpi_name);
+		return 0;
+	}
+
+	void recordLibrary(const char *const library, const char *const path)
+	{
+		if (!skipUnchanged || !testHistory || testHistory->anyFailed(library))
+			return;
+		// There's no way to tell which loaded objects a library pulled in, so take all of them bar the
+		// other test libraries, which at worst makes the library depend on more than it needs to
+		std::vector<std::string> paths{};
+		dl_iterate_phdr(collectObject, &paths);
+		// The library itself must always be among its files, however the loader names it
+		if (std::find(paths.begin(), paths.end(), path) == paths.end())
+			paths.emplace_back(path);
+		std::vector<libraryFile_t> files{};
+		files.reserve(paths.size());
+		for (const auto &object : paths)
+		{
+			{
+				std::lock_guard<std::mutex> lock{cacheLock};
+				if (object != path && testLibraries.count(object))
+					continue;
+			}
+			uint64_t hash{};
+			if (!hashFile(object, hash))
+				return;
+			files.push_back({object, hash});
+		}
+		testHistory->recordLibrary(library, std::move(files));
+	}
+#else
+	void recordLibrary(const char *, const char *) { }
+#endif
+} // namespace crunch
@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef LIBRARY_CACHE__HXX
+#define LIBRARY_CACHE__HXX
+
+#include <atomic>
+#include <cstdint>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// Whether to skip test libraries that passed last time and whose files haven't changed since
+	CRUNCHpp_API bool skipUnchanged;
+	// How many test libraries have been skipped this run for being unchanged
+	CRUNCHpp_API std::atomic<uint32_t> cachedLibraries;
+	// Whether skipUnchanged can be honoured on this platform
+	CRUNCHpp_API const bool libraryCacheSupported;
+
+	// Returns true if the library passed last time and neither it nor any of its dependencies have
+	// changed since, going by the hashes of their contents kept in the history
+	CRUNCHpp_API bool libraryUnchanged(const char *library);
+	// Drops the hashes of the files seen so far, for a new run after files may have been rebuilt
+	CRUNCHpp_API void forgetFileHashes();
+	// Marks the file at path as a test library being run, so it isn't taken for another's dependency
+	CRUNCHpp_API void noteTestLibrary(const char *path);
+	// Records the files the library at path and its dependencies were loaded from if all its tests ran
+	// and passed, so the next run can skip it if they are left unchanged
+	CRUNCHpp_API void recordLibrary(const char *library, const char *path);
+} // namespace crunch
+
+#endif /*LIBRARY_CACHE__HXX*/
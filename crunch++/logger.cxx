@@ -1,4 +1,6 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <substrate/utility>
 #ifndef _WINDOWS
@@ -11,6 +13,8 @@
 #endif
 #include "core.hxx"
 #include "logger.hxx"
+#include "output.hxx"
+#include "reporter.hxx"
 
 namespace crunch
 {
@@ -20,13 +24,30 @@ namespace crunch
 
 	testLog *logger = nullptr;
 	bool isTTY = true;
+	// When set, testPrintf() output from this thread goes here rather than to the console
+	static thread_local std::string *capturedOutput{nullptr};
+	// When set, failures logged from this thread and anything printed after them go here, to be reported later
+	static thread_local std::string *deferredFailure{nullptr};
+	// The failures logged from this thread, so a test's own failures can be told apart from those of
+	// tests running alongside it
+	static thread_local uint32_t threadFailures_{0};
+#ifndef _WINDOWS
+	// The console width as last looked up, or 0 if it needs looking up again
+	static std::atomic<int16_t> columns{0};
+#endif
 
 	int16_t getColumns()
 	{
 #ifndef _WINDOWS
+		// Looking the width up is a system call, which adds up when it's done for every test
+		const auto cached{columns.load(std::memory_order_relaxed)};
+		if (cached)
+			return cached;
 		struct winsize win{};
 		ioctl(STDOUT_FILENO, TIOCGWINSZ, &win);
-		return (!win.ws_col ? 80 : win.ws_col) - 8;
+		const auto result{int16_t((!win.ws_col ? 80 : win.ws_col) - 8)};
+		columns.store(result, std::memory_order_relaxed);
+		return result;
 #else
 		CONSOLE_SCREEN_BUFFER_INFO window{};
 		GetConsoleScreenBufferInfo(console, &window);
@@ -34,11 +55,52 @@ namespace crunch
 #endif
 	}
 
+	void refreshColumns() noexcept
+	{
+#ifndef _WINDOWS
+		columns.store(0, std::memory_order_relaxed);
+#endif
+	}
+
+	void captureOutput(std::string *const buffer) noexcept
+		{ capturedOutput = buffer; }
+
+	bool capturingOutput() noexcept
+		{ return capturedOutput; }
+
+	uint32_t threadFailures() noexcept { return threadFailures_; }
+
+	std::string *deferFailures(std::string *const record) noexcept
+	{
+		auto *const outer{deferredFailure};
+		deferredFailure = record;
+		return outer;
+	}
+
+	std::size_t vaCapturePrintf(std::string &buffer, const char *format, va_list args)
+	{
+		va_list lenArgs;
+		va_copy(lenArgs, args);
+		const auto length{vsnprintf(nullptr, 0, format, lenArgs)};
+		va_end(lenArgs);
+		if (length <= 0)
+			return 0;
+		const auto offset{buffer.length()};
+		// vsnprintf() needs room for the NUL terminator, which we then trim back off
+		buffer.resize(offset + std::size_t(length) + 1U);
+		vsnprintf(&buffer[offset], std::size_t(length) + 1U, format, args);
+		buffer.resize(offset + std::size_t(length));
+		return std::size_t(length);
+	}
+
 	std::size_t vaTestPrintf(const char *format, va_list args)
 	{
-		const auto ret{vfprintf(logger ? logger->stdout_ : stdout, format, args)};
-		fflush(logger ? logger->stdout_ : stdout);
-		return ret;
+		if (deferredFailure)
+			return vaCapturePrintf(*deferredFailure, format, args);
+		if (capturedOutput)
+			return vaCapturePrintf(*capturedOutput, format, args);
+		// This is left buffered until syncOutput() or the buffer fills, so as not to make a write per call
+		return vfprintf(outputStream(), format, args);
 	}
 
 	std::size_t testPrintf(const char *format, ...) // NOLINT
@@ -50,7 +112,7 @@ namespace crunch
 		return result;
 	}
 
-	void printOk() { testPrintf(" [  OK  ]\n"); }
+	void printOk(const std::string &prefix) { testPrintf(" %s[  OK  ]\n", prefix.c_str()); }
 	void printFailure() { testPrintf(" [ FAIL ]\n"); }
 	void printSkip() { testPrintf(" [ SKIP ]\n"); }
 	void printAborted() { testPrintf("[ **** ABORTED **** ]\n"); }
@@ -65,14 +127,19 @@ namespace crunch
 #endif
 	}
 
+	// Works out the column to start the OK marker at, along with any text to print before it such as the test's timing
+	static int16_t okColumn(const std::string &prefix)
+		{ return std::max<int16_t>(int16_t(getColumns() - int16_t(prefix.length())), 1); }
+
 #ifndef _WINDOWS
-	void echoOk()
+	void echoOk(const std::string &prefix = {})
 	{
 		if (isTTY)
-			testPrintf(CURS_UP SET_COL BRACKET "[" SUCCESS "  OK  " BRACKET "]" NEWLINE, getColumns());
+			testPrintf(CURS_UP SET_COL "%s" BRACKET "[" SUCCESS "  OK  " BRACKET "]" NEWLINE, okColumn(prefix),
+				prefix.c_str());
 		else
-			printOk();
-		++passes;
+			printOk(prefix);
+		++results.passes;
 	}
 
 	void echoFailure()
@@ -81,7 +148,8 @@ namespace crunch
 			testPrintf(" " SET_COL BRACKET "[" FAILURE " FAIL " BRACKET "]" NEWLINE, getColumns());
 		else
 			printFailure();
-		++failures;
+		++results.failures;
+		++threadFailures_;
 	}
 
 	void echoSkip()
@@ -90,7 +158,7 @@ namespace crunch
 			testPrintf(" " SET_COL BRACKET "[" WARNING " SKIP " BRACKET "]" NEWLINE, getColumns());
 		else
 			printSkip();
-		++passes;
+		++results.passes;
 	}
 
 	void echoAborted()
@@ -102,15 +170,16 @@ namespace crunch
 		throw threadExit_t(2);
 	}
 #else
-	void echoOk()
+	void echoOk(const std::string &prefix = {})
 	{
 		if (isTTY)
 		{
 			CONSOLE_SCREEN_BUFFER_INFO cursor;
 			GetConsoleScreenBufferInfo(console, &cursor);
-			cursor.dwCursorPosition.X = getColumns();
+			cursor.dwCursorPosition.X = okColumn(prefix);
 			--cursor.dwCursorPosition.Y;
 			SetConsoleCursorPosition(console, cursor.dwCursorPosition);
+			testPrintf("%s", prefix.c_str());
 			SetConsoleTextAttribute(console, FOREGROUND_BLUE | FOREGROUND_INTENSITY);
 			testPrintf("[");
 			SetConsoleTextAttribute(console, FOREGROUND_GREEN | FOREGROUND_INTENSITY);
@@ -121,8 +190,8 @@ namespace crunch
 			testPrintf("\n");
 		}
 		else
-			printOk();
-		++passes;
+			printOk(prefix);
+		++results.passes;
 	}
 
 	void echoFailure()
@@ -145,7 +214,8 @@ namespace crunch
 		}
 		else
 			printFailure();
-		++failures;
+		++results.failures;
+		++threadFailures_;
 	}
 
 	void echoSkip()
@@ -168,7 +238,7 @@ namespace crunch
 		}
 		else
 			printSkip();
-		++passes;
+		++results.passes;
 	}
 
 	void echoAborted()
@@ -192,10 +262,23 @@ namespace crunch
 
 	void logResult(resultType type, const char *message, ...) // NOLINT
 	{
+		va_list args;
+		// A deferred failure is only recorded, so doesn't end up on the console or counted yet
+		if (deferredFailure && type == RESULT_FAILURE)
+		{
+			va_start(args, message);
+			vaCapturePrintf(*deferredFailure, message, args);
+			va_end(args);
+			deferredFailure->push_back('\n');
+			return;
+		}
+
 		if (isTTY)
 			normal();
 
-		va_list args;
+		va_start(args, message);
+		noteResult(type, message, args);
+		va_end(args);
 		va_start(args, message);
 		vaTestPrintf(message, args);
 		va_end(args);
@@ -215,6 +298,13 @@ namespace crunch
 				echoAborted();
 		}
 	}
+
+	void logOk(const testTiming_t &timing)
+	{
+		if (isTTY)
+			normal();
+		echoOk(formatTiming(timing) + ' ');
+	}
 } // namespace crunch
 
 using crunch::logger;
@@ -224,6 +314,8 @@ crunch::testLog *startLogging(const char *fileName)
 	if (logger || !fileName)
 		return nullptr;
 	auto logger_ = substrate::make_unique<crunch::testLog>();
+	// Anything still buffered for the console must get there before stdout is swapped out
+	fflush(stdout);
 	logger_->file = fopen(fileName, "w"); // NOLINT(cppcoreguidelines-owning-memory)
 	if (!logger_->file)
 		return nullptr;
@@ -251,6 +343,7 @@ crunch::testLog *startLogging(const char *fileName)
 //	locking(fileFD, LK_LOCK, -1);
 	dup2(fileFD, fileno(logger->realStdout));
 #endif
+	crunch::refreshColumns();
 	return logger;
 }
 
@@ -268,6 +361,7 @@ void stopLogging(crunch::testLog *loggerPtr)
 //	locking(fileno(logger_->file), LK_UNLCK, -1);
 #endif
 	logger = nullptr;
+	crunch::refreshColumns();
 	fclose(logger_->stdout_); // NOLINT(cppcoreguidelines-owning-memory)
 	fclose(logger_->file); // NOLINT(cppcoreguidelines-owning-memory)
 }
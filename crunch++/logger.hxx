@@ -7,7 +7,9 @@
 #include <windows.h>
 #endif
 #include "crunch++.h"
+#include "timing.hxx"
 #include <cstdarg>
+#include <string>
 
 namespace crunch
 {
@@ -33,11 +35,25 @@ namespace crunch
 #endif
 	CRUNCHpp_API testLog *logger;
 
+	CRUNCHpp_API void captureOutput(std::string *buffer) noexcept;
+	CRUNCHpp_API bool capturingOutput() noexcept;
+	// How many failures have been logged from the calling thread
+	uint32_t threadFailures() noexcept;
+	// While record is set, failures logged from the calling thread and anything printed after them are
+	// written to it rather than reported, so the failure of an expectation can be reported once its test
+	// is over. Returns the record that was being written to before.
+	std::string *deferFailures(std::string *record) noexcept;
+	// Appends the formatted text to buffer, returning how long it was
+	size_t vaCapturePrintf(std::string &buffer, const char *format, va_list args);
 	CRUNCHpp_API size_t vaTestPrintf(const char *format, va_list args);
 	CRUNCHpp_API size_t testPrintf(const char *format, ...);
 	CRUNCHpp_API int16_t getColumns();
+	// Makes getColumns() look the console width up again, as when the console is resized or stdout redirected
+	CRUNCHpp_API void refreshColumns() noexcept;
 	CRUNCHpp_API void echoAborted();
 	CRUNCHpp_API void logResult(resultType type, const char *message, ...);
+	// Logs the success of a test along with how long it took
+	void logOk(const testTiming_t &timing);
 	CRUNCHpp_API void newline();
 } // namespace crunch
 
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#ifdef __linux__
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <substrate/utility>
+#include "manifest.hxx"
+#include "filter.hxx"
+
+namespace crunch
+{
+#ifdef __linux__
+	const bool manifestSupported{true};
+#else
+	const bool manifestSupported{false};
+#endif
+
+	bool testManifest_t::mayMatch(const std::string &pattern) const noexcept
+	{
+		// Which class each test is in isn't recorded, so try each test in every class
+		for (const auto &suite : suites)
+		{
+			for (const auto &test : tests)
+			{
+				if (globMatch(pattern.c_str(), (suite + "::" + test).c_str()))
+					return true;
+			}
+		}
+		if (!suites.empty())
+			return false;
+		// Without the classes, any pattern that could match "::test" once the class name is taken off its start
+		for (const auto &test : tests)
+		{
+			const auto name{"::" + test};
+			for (std::size_t offset{0}; offset <= pattern.length(); ++offset)
+			{
+				if (globMatch(pattern.c_str() + offset, name.c_str()))
+					return true;
+			}
+		}
+		return false;
+	}
+
+	static void addRecord(std::vector<std::string> &records, std::string record)
+	{
+		if (!record.empty() && std::find(records.begin(), records.end(), record) == records.end())
+			records.emplace_back(std::move(record));
+	}
+
+	testManifest_t parseManifest(const char *const data, const std::size_t length)
+	{
+		testManifest_t manifest{};
+		for (std::size_t offset{0}; offset < length;)
+		{
+			const auto *const record{data + offset};
+			const auto recordLength{strnlen(record, length - offset)};
+			offset += recordLength + 1;
+			if (!recordLength)
+				continue;
+			else if (*record == 'U')
+				manifest.complete = false;
+			else if (*record == 'T' || *record == 'C')
+				addRecord(manifest.tests, {record + 1, recordLength - 1});
+		}
+		return manifest;
+	}
+
+	bool filtersMayMatch(const testManifest_t &manifest)
+	{
+		if (nameFilters.empty() || !tagFilters.empty() || manifest.tests.empty() || !manifest.complete)
+			return true;
+		bool including{false};
+		for (const auto &filter : nameFilters)
+		{
+			if (filter[0] == '-')
+				continue;
+			including = true;
+			if (manifest.mayMatch(filter))
+				return true;
+		}
+		return !including;
+	}
+
+#ifdef __linux__
+	// The test class a symbol names, if it's an instantiation of crunch::internal::makeTestClass<>(), which
+	// demangles to "std::unique_ptr<testsuite, ...> crunch::internal::makeTestClass<Class>()"
+	static std::string testClassFor(const char *const symbol)
+	{
+		static const char mangledPrefix[]{"_ZN6crunch8internal13makeTestClassI"};
+		if (strncmp(symbol, mangledPrefix, sizeof(mangledPrefix) - 1) != 0)
+			return {};
+		const auto name{substrate::decode_typename(symbol)};
+		static const std::string prefix{"crunch::internal::makeTestClass<"};
+		static const std::string suffix{">()"};
+		const auto begin{name.find(prefix)};
+		if (begin == std::string::npos || name.length() < begin + prefix.length() + suffix.length() ||
+			name.compare(name.length() - suffix.length(), suffix.length(), suffix) != 0)
+			return {};
+		return name.substr(begin + prefix.length(), name.length() - suffix.length() - begin - prefix.length());
+	}
+
+	// The test a symbol names, if it's an instantiation of crunch::internal::runTableTest<>(), which demangles
+	// to "void crunch::internal::runTableTest<Class, &Class::test>(testsuite&)"
+	static std::string tableTestFor(const char *const symbol)
+	{
+		static const char mangledPrefix[]{"_ZN6crunch8internal12runTableTestI"};
+		if (strncmp(symbol, mangledPrefix, sizeof(mangledPrefix) - 1) != 0)
+			return {};
+		const auto name{substrate::decode_typename(symbol)};
+		static const std::string suffix{">(testsuite&)"};
+		if (name.length() < suffix.length() ||
+			name.compare(name.length() - suffix.length(), suffix.length(), suffix) != 0)
+			return {};
+		const auto end{name.length() - suffix.length()};
+		const auto begin{name.rfind("::", end)};
+		if (begin == std::string::npos)
+			return {};
+		return name.substr(begin + 2, end - begin - 2);
+	}
+
+	// Reads the manifest section, and the test classes and table tests from the dynamic symbol table, of an
+	// ELF file of the class given by header_t, section_t and symbol_t, checking everything we follow stays
+	// inside the file. Libraries with table tests have a manifest even without the section, as they were
+	// built with headers that would have put a 'U' record in it for any test the manifest can't name.
+	template<typename header_t, typename section_t, typename symbol_t> static bool readELF(const uint8_t *const file,
+		const std::size_t length, testManifest_t &manifest)
+	{
+		if (length < sizeof(header_t))
+			return false;
+		header_t header{};
+		memcpy(&header, file, sizeof(header_t));
+		if (!header.e_shoff || header.e_shentsize != sizeof(section_t) || header.e_shstrndx >= header.e_shnum ||
+			header.e_shoff > length || header.e_shnum > (length - header.e_shoff) / sizeof(section_t))
+			return false;
+		const auto readSection = [&](const std::size_t index, section_t &section) noexcept
+		{
+			memcpy(&section, file + header.e_shoff + index * sizeof(section_t), sizeof(section_t));
+			return section.sh_offset <= length && section.sh_size <= length - section.sh_offset;
+		};
+		section_t names{};
+		if (!readSection(header.e_shstrndx, names))
+			return false;
+		const auto *const nameTable{reinterpret_cast<const char *>(file + names.sh_offset)}; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		static const char manifestName[]{"crunch_manifest"};
+		bool found{false};
+		std::vector<std::string> suites{};
+		std::vector<std::string> tableTests{};
+		for (std::size_t index{0}; index < header.e_shnum; ++index)
+		{
+			section_t section{};
+			if (!readSection(index, section))
+				continue;
+			if (section.sh_type == SHT_PROGBITS && section.sh_name < names.sh_size &&
+				strncmp(nameTable + section.sh_name, manifestName, names.sh_size - section.sh_name) == 0)
+			{
+				const auto *const data{reinterpret_cast<const char *>(file + section.sh_offset)}; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+				manifest = parseManifest(data, section.sh_size);
+				found = true;
+			}
+			section_t strings{};
+			if (section.sh_type != SHT_DYNSYM || section.sh_entsize != sizeof(symbol_t) ||
+				section.sh_link >= header.e_shnum || !readSection(section.sh_link, strings) || !strings.sh_size)
+				continue;
+			const auto *const stringTable{reinterpret_cast<const char *>(file + strings.sh_offset)}; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+			for (std::size_t offset{0}; offset + sizeof(symbol_t) <= section.sh_size; offset += sizeof(symbol_t))
+			{
+				symbol_t symbol{};
+				memcpy(&symbol, file + section.sh_offset + offset, sizeof(symbol_t));
+				// Only the library's own instantiations, which must have a name NUL terminated within the table
+				if (symbol.st_shndx == SHN_UNDEF || symbol.st_name >= strings.sh_size ||
+					!memchr(stringTable + symbol.st_name, 0, strings.sh_size - symbol.st_name))
+					continue;
+				addRecord(suites, testClassFor(stringTable + symbol.st_name));
+				addRecord(tableTests, tableTestFor(stringTable + symbol.st_name));
+			}
+		}
+		if (!found && tableTests.empty())
+			return false;
+		manifest.suites = std::move(suites);
+		for (auto &test : tableTests)
+			addRecord(manifest.tests, std::move(test));
+		return true;
+	}
+
+	testManifest_t readManifest(const char *const path)
+	{
+		const auto fd{open(path, O_RDONLY | O_CLOEXEC)};
+		if (fd == -1)
+			return {};
+		struct stat file{};
+		if (fstat(fd, &file) || file.st_size < EI_NIDENT)
+		{
+			close(fd);
+			return {};
+		}
+		const auto length{std::size_t(file.st_size)};
+		auto *const mapping{mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0)};
+		close(fd);
+		if (mapping == MAP_FAILED)
+			return {};
+		const auto *const contents{static_cast<const uint8_t *>(mapping)};
+		// We only read the manifests of libraries we could load, so they match us in byte order
+		constexpr uint16_t byteOrder{1};
+		const auto nativeData{*reinterpret_cast<const uint8_t *>(&byteOrder) ? ELFDATA2LSB : ELFDATA2MSB}; // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		testManifest_t manifest{};
+		if (memcmp(contents, ELFMAG, SELFMAG) == 0 && contents[EI_DATA] == nativeData)
+		{
+			if (contents[EI_CLASS] == ELFCLASS64)
+				readELF<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(contents, length, manifest);
+			else if (contents[EI_CLASS] == ELFCLASS32)
+				readELF<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(contents, length, manifest);
+		}
+		munmap(mapping, length);
+		return manifest;
+	}
+#else
+	testManifest_t readManifest(const char *) { return {}; }
+#endif
+} // namespace crunch
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef MANIFEST__HXX
+#define MANIFEST__HXX
+
+#include <string>
+#include <vector>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// Whether test library manifests can be read on this platform
+	CRUNCHpp_API const bool manifestSupported;
+
+	// What the manifest a test library was built with says it holds, as read from its file without
+	// loading it. See CRUNCHpp_MANIFEST_RECORD() in crunch++.h for how the manifest is laid out.
+	struct testManifest_t final
+	{
+		// The test classes, named as the runner names them, and the names of the tests in them, each only
+		// once, in the order first recorded. Which class each test belongs to isn't recorded.
+		std::vector<std::string> suites{};
+		std::vector<std::string> tests{};
+		// Whether the manifest names every test registered by the test classes it records
+		bool complete{true};
+
+		// Whether a test with a name recorded here, in any test class, could match the --filter style pattern
+		CRUNCH_VIS bool mayMatch(const std::string &pattern) const noexcept;
+	};
+
+	// Reads the records of a manifest, as found in the crunch_manifest section of a test library
+	CRUNCHpp_API testManifest_t parseManifest(const char *data, std::size_t length);
+	// Reads the manifest of the test library at path, which comes back empty if the
+	// library has none (or the manifest can't be read on this platform)
+	CRUNCHpp_API testManifest_t readManifest(const char *path);
+	// Whether the --filter patterns could select any of the tests the manifest names, so whether its
+	// library must be loaded to find out. Tags aren't recorded, so tag filters rule this out, and
+	// only a complete manifest can rule a library out.
+	CRUNCHpp_API bool filtersMayMatch(const testManifest_t &manifest);
+} // namespace crunch
+
+#endif /*MANIFEST__HXX*/
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "output.hxx"
+#include "logger.hxx"
+#include "capture.hxx"
+
+namespace crunch
+{
+	outputWriter_t *testOutputWriter{nullptr};
+	constexpr std::chrono::milliseconds outputWriter_t::flushInterval;
+
+	// While test output is being captured, ours must go around the capture
+	FILE *outputStream() noexcept
+		{ return logger ? logger->stdout_ : consoleStream ? consoleStream : stdout; }
+
+	void flushOutput() noexcept
+		{ fflush(outputStream()); }
+
+	void syncOutput() noexcept
+	{
+		// Output being captured by this thread is written out by whoever replays it
+		if (capturingOutput())
+			return;
+		if (testOutputWriter)
+			testOutputWriter->notify();
+		else
+			flushOutput();
+	}
+
+	outputWriter_t::outputWriter_t() : writer{[this]() { run(); }} { }
+
+	outputWriter_t::~outputWriter_t() noexcept
+	{
+		{
+			std::lock_guard<std::mutex> guard{lock};
+			stopping = true;
+		}
+		wake.notify_one();
+		writer.join();
+		flushOutput();
+	}
+
+	void outputWriter_t::notify() noexcept
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		pending = true;
+		wake.notify_one();
+	}
+
+	void outputWriter_t::run() noexcept
+	{
+		std::unique_lock<std::mutex> guard{lock};
+		while (true)
+		{
+			wake.wait(guard, [this]() { return pending || stopping; });
+			if (stopping)
+				return;
+			pending = false;
+			guard.unlock();
+			// Flush every stream rather than just outputStream(), as the one that is may be closed by
+			// the run's log stopping while we're at it - fflush(nullptr) holds off fclose() for us
+			fflush(nullptr);
+			// Let more output build up before writing again, so it goes out in as few writes as possible
+			std::this_thread::sleep_for(flushInterval);
+			guard.lock();
+		}
+	}
+} // namespace crunch
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef OUTPUT__HXX
+#define OUTPUT__HXX
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// The stream testPrintf() writes to when its output isn't being captured by the calling thread
+	FILE *outputStream() noexcept;
+	// Writes out whatever testPrintf() has buffered so far, from the calling thread
+	CRUNCHpp_API void flushOutput() noexcept;
+	// Called as each test starts so the output so far, including the test's name, is on its way to
+	// the console should the test hang or write to stderr. Hands off to the output writer if there is one.
+	void syncOutput() noexcept;
+
+	// A background thread that batches up testPrintf()'s buffered output, writing it out at most once
+	// every flushInterval, so the threads running tests never wait on the console
+	struct outputWriter_t final
+	{
+	private:
+		constexpr static std::chrono::milliseconds flushInterval{10};
+
+		// Guards pending and stopping, which say whether the writer has anything to do
+		std::mutex lock{};
+		std::condition_variable wake{};
+		bool pending{false};
+		bool stopping{false};
+		// Last, so everything the thread uses exists by the time it starts
+		std::thread writer;
+
+		void run() noexcept;
+
+	public:
+		CRUNCH_VIS outputWriter_t();
+		outputWriter_t(const outputWriter_t &) = delete;
+		outputWriter_t(outputWriter_t &&) = delete;
+		CRUNCH_VIS ~outputWriter_t() noexcept;
+		outputWriter_t &operator =(const outputWriter_t &) = delete;
+		outputWriter_t &operator =(outputWriter_t &&) = delete;
+
+		void notify() noexcept;
+	};
+
+	// The writer the runner sets up for the duration of a run with --async-output, or nullptr if there isn't one
+	CRUNCHpp_API outputWriter_t *testOutputWriter;
+} // namespace crunch
+
+#endif /*OUTPUT__HXX*/
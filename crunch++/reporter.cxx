@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <array>
+#include <cinttypes>
+#include <substrate/utility>
+#include "reporter.hxx"
+#include "history.hxx"
+
+namespace crunch
+{
+	reporter_t *testReporter{nullptr};
+
+	reporter_t::~reporter_t() noexcept
+		{ fclose(file); } // NOLINT(cppcoreguidelines-owning-memory)
+
+	void reporter_t::test(const char *const library, const std::string &suite, const char *const test,
+		const testOutcome_t outcome, const testTiming_t &timing, const std::string &message)
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		writeTest(library, suite, test, outcome, timing, message);
+	}
+
+	void reporter_t::finish(const testResults_t &results)
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		writeEnd(results);
+		fflush(file);
+	}
+
+	static const char *outcomeName(const testOutcome_t outcome) noexcept
+	{
+		switch (outcome)
+		{
+			case testOutcome_t::passed:
+				return "passed";
+			case testOutcome_t::failed:
+				return "failed";
+			default:
+				return "skipped";
+		}
+	}
+
+	// Escapes text for use in XML content and attributes. Control characters other than
+	// whitespace can't appear in XML 1.0 at all, so are dropped.
+	static std::string xmlEscape(const std::string &text)
+	{
+		std::string result{};
+		result.reserve(text.length());
+		for (const auto chr : text)
+		{
+			switch (chr)
+			{
+				case '&':
+					result += "&amp;";
+					break;
+				case '<':
+					result += "&lt;";
+					break;
+				case '>':
+					result += "&gt;";
+					break;
+				case '"':
+					result += "&quot;";
+					break;
+				case '\'':
+					result += "&apos;";
+					break;
+				// Written as references so they survive attribute value normalisation
+				case '\n':
+					result += "&#10;";
+					break;
+				case '\r':
+					result += "&#13;";
+					break;
+				case '\t':
+					result += "&#9;";
+					break;
+				default:
+					if (uint8_t(chr) >= 0x20U)
+						result += chr;
+			}
+		}
+		return result;
+	}
+
+	std::string jsonEscape(const std::string &text)
+	{
+		std::string result{};
+		result.reserve(text.length());
+		for (const auto chr : text)
+		{
+			switch (chr)
+			{
+				case '"':
+					result += "\\\"";
+					break;
+				case '\\':
+					result += "\\\\";
+					break;
+				case '\n':
+					result += "\\n";
+					break;
+				case '\r':
+					result += "\\r";
+					break;
+				case '\t':
+					result += "\\t";
+					break;
+				default:
+					if (uint8_t(chr) < 0x20U)
+					{
+						std::array<char, 7> escape{};
+						snprintf(escape.data(), escape.size(), "\\u%04x", unsigned(uint8_t(chr)));
+						result += escape.data();
+					}
+					else
+						result += chr;
+			}
+		}
+		return result;
+	}
+
+	// JUnit XML as understood by Jenkins, GitLab and friends. As the counts a <testsuite> normally
+	// carries aren't known until the end, the whole run goes in one suite without them, and each
+	// test's library and suite go in its classname as "library.Suite"
+	struct junitReporter_t final : reporter_t
+	{
+	private:
+		void writeTest(const char *const library, const std::string &suite, const char *const test,
+			const testOutcome_t outcome, const testTiming_t &timing, const std::string &message) final
+		{
+			fprintf(file, "\t\t<testcase classname=\"%s.%s\" name=\"%s\" time=\"%.6f\"",
+				xmlEscape(library).c_str(), xmlEscape(suite).c_str(), xmlEscape(test).c_str(),
+				double(timing.wallTime) / 1e9);
+			if (outcome == testOutcome_t::passed)
+				fputs("/>\n", file);
+			else
+			{
+				const auto escapedMessage{xmlEscape(message)};
+				if (outcome == testOutcome_t::failed)
+					fprintf(file, ">\n\t\t\t<failure message=\"%s\">%s</failure>\n\t\t</testcase>\n",
+						escapedMessage.c_str(), escapedMessage.c_str());
+				else
+					fprintf(file, ">\n\t\t\t<skipped message=\"%s\"/>\n\t\t</testcase>\n", escapedMessage.c_str());
+			}
+		}
+
+		void writeEnd(const testResults_t &) final
+			{ fputs("\t</testsuite>\n</testsuites>\n", file); }
+
+	public:
+		junitReporter_t(FILE *const file_) : reporter_t{file_}
+		{
+			fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites name=\"crunch++\">\n"
+				"\t<testsuite name=\"crunch++\">\n", file);
+		}
+	};
+
+	// A JSON document of the form {"tests": [...], "summary": {...}} with one test record per line
+	struct jsonReporter_t final : reporter_t
+	{
+	private:
+		bool first{true};
+
+		void writeTest(const char *const library, const std::string &suite, const char *const test,
+			const testOutcome_t outcome, const testTiming_t &timing, const std::string &message) final
+		{
+			fprintf(file, "%s\t\t{\"library\": \"%s\", \"suite\": \"%s\", \"test\": \"%s\", \"outcome\": \"%s\", "
+				"\"wallTime\": %" PRIu64 ", \"cpuTime\": %" PRIu64, first ? "" : ",\n", jsonEscape(library).c_str(),
+				jsonEscape(suite).c_str(), jsonEscape(test).c_str(), outcomeName(outcome), timing.wallTime,
+				timing.cpuTime);
+			if (!message.empty())
+				fprintf(file, ", \"message\": \"%s\"", jsonEscape(message).c_str());
+			fputc('}', file);
+			first = false;
+		}
+
+		void writeEnd(const testResults_t &results) final
+		{
+			fprintf(file, "%s\t],\n\t\"summary\": {\"total\": %" PRIu64 ", \"failures\": %" PRIu32 "}\n}\n",
+				first ? "" : "\n", results.total(), results.failures.load());
+		}
+
+	public:
+		jsonReporter_t(FILE *const file_) : reporter_t{file_}
+			{ fputs("{\n\t\"tests\": [\n", file); }
+	};
+
+	std::unique_ptr<reporter_t> makeReporter(const std::string &format, FILE *const file)
+	{
+		if (format == "junit")
+			return makeUnique<junitReporter_t>(file);
+		else if (format == "json")
+			return makeUnique<jsonReporter_t>(file);
+		return nullptr;
+	}
+
+	std::unique_ptr<reporter_t> makeReporter(const std::string &format, const std::string &fileName)
+	{
+		if (format != "junit" && format != "json")
+			return nullptr;
+		auto *const file{fopen(fileName.c_str(), "w")};
+		if (!file)
+			return nullptr;
+		return makeReporter(format, file);
+	}
+
+	testReport_t &threadReport() noexcept
+	{
+		static thread_local testReport_t report{};
+		return report;
+	}
+
+	void noteResult(const resultType type, const char *const message, va_list args)
+	{
+		if (!testReporter || (type != RESULT_FAILURE && type != RESULT_SKIP))
+			return;
+		auto &report{threadReport()};
+		if (!report.message.empty())
+			report.message += '\n';
+		vaCapturePrintf(report.message, message, args);
+		if (type == RESULT_SKIP)
+			report.skipped = true;
+	}
+
+	void reportTest(const internal::cxxTest &test, const bool failed, const testTiming_t &timing,
+		const testReport_t &report)
+	{
+		if (!testReporter)
+			return;
+		const auto *const library{currentLibrary()};
+		const auto *const suite{currentSuite()};
+		const auto outcome{failed ? testOutcome_t::failed :
+			report.skipped ? testOutcome_t::skipped : testOutcome_t::passed};
+		testReporter->test(library ? library : "", suite ? substrate::decode_typename(suite) : std::string{},
+			test.name(), outcome, timing, report.message);
+	}
+} // namespace crunch
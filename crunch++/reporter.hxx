@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef REPORTER__HXX
+#define REPORTER__HXX
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "crunch++.h"
+#include "logger.hxx"
+#include "results.hxx"
+#include "timing.hxx"
+
+namespace crunch
+{
+	enum class testOutcome_t : uint8_t
+	{
+		passed,
+		failed,
+		skipped
+	};
+
+	// What logResult() has been told of how the test running on a thread went, for the reporters
+	struct testReport_t final
+	{
+		// The messages the test failed or was skipped with, one per line
+		std::string message{};
+		bool skipped{false};
+	};
+
+	// Writes a machine readable record of each test to a file as the test completes, so the run's
+	// results are never held in memory beyond the record being written
+	struct reporter_t
+	{
+	private:
+		// Records come in from every thread that reports the results of a suite
+		std::mutex lock{};
+
+	protected:
+		FILE *file;
+
+		// Suite and test name the test, which is in the test library named
+		virtual void writeTest(const char *library, const std::string &suite, const char *test,
+			testOutcome_t outcome, const testTiming_t &timing, const std::string &message) = 0;
+		virtual void writeEnd(const testResults_t &results) = 0;
+
+	public:
+		reporter_t(FILE *file_) noexcept : file{file_} { }
+		reporter_t(const reporter_t &) = delete;
+		reporter_t(reporter_t &&) = delete;
+		virtual ~reporter_t() noexcept;
+		reporter_t &operator =(const reporter_t &) = delete;
+		reporter_t &operator =(reporter_t &&) = delete;
+
+		void test(const char *library, const std::string &suite, const char *test, testOutcome_t outcome,
+			const testTiming_t &timing, const std::string &message);
+		// Writes out the end of the report, after which no more tests may be reported
+		CRUNCH_VIS void finish(const testResults_t &results);
+		void flush() noexcept { fflush(file); }
+	};
+
+	// The reporter the runner sets up for the duration of a run with --reporter, or nullptr if there isn't one
+	CRUNCHpp_API reporter_t *testReporter;
+
+	// Makes the reporter for the format named ("junit" or "json"), writing to the file named.
+	// Returns nullptr if the format is not one we know or the file can't be written.
+	CRUNCHpp_API std::unique_ptr<reporter_t> makeReporter(const std::string &format, const std::string &fileName);
+	// As above, but writing to the stream given, which the reporter takes ownership of if the format is known
+	CRUNCHpp_API std::unique_ptr<reporter_t> makeReporter(const std::string &format, FILE *file);
+	// Escapes text for use in a JSON string
+	CRUNCHpp_API std::string jsonEscape(const std::string &text);
+
+	// The report being gathered on the calling thread, which testsuite::testRunner() starts afresh for each test
+	testReport_t &threadReport() noexcept;
+	// Notes a result given to logResult() in the calling thread's report, if there's a reporter to want it
+	void noteResult(resultType type, const char *message, va_list args);
+	// Writes the record of a test that has completed to the run's reporter, if there is one
+	void reportTest(const internal::cxxTest &test, bool failed, const testTiming_t &timing,
+		const testReport_t &report);
+} // namespace crunch
+
+#endif /*REPORTER__HXX*/
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
+#include "results.hxx"
+
+namespace crunch
+{
+	std::atomic<uint32_t> passes{0}, failures{0};
+	testResults_t results{passes, failures};
+
+	// How many shards have been handed out, across every testResults_t
+	static std::atomic<std::size_t> shardsInUse{0};
+	static thread_local std::size_t threadShard{SIZE_MAX};
+
+	resultShard_t &testResults_t::shard() noexcept
+	{
+		if (threadShard == SIZE_MAX)
+			threadShard = shardsInUse++ % maxShards;
+		return shards[threadShard];
+	}
+
+	uint32_t testResults_t::sum(std::atomic<uint32_t> resultShard_t::*const counter) const noexcept
+	{
+		const auto count{std::min(shardsInUse.load(std::memory_order_relaxed), maxShards)};
+		uint32_t result{0};
+		// Shards may individually have gone negative if a result was counted on one thread and
+		// taken back on another, but that all comes out in the wash of unsigned arithmetic
+		for (std::size_t i{0}; i < count; ++i)
+			result += (shards[i].*counter).load(std::memory_order_relaxed);
+		return result;
+	}
+
+	void testResults_t::reset() noexcept
+	{
+		for (auto &resultShard : shards)
+		{
+			resultShard.passes.store(0, std::memory_order_relaxed);
+			resultShard.failures.store(0, std::memory_order_relaxed);
+		}
+		passes.resetAdjustment();
+		failures.resetAdjustment();
+	}
+
+	uint32_t resultCounter_t::load() const noexcept
+		{ return results.sum(counter) + (adjustment ? adjustment->load(std::memory_order_relaxed) : 0U); }
+
+	void resultCounter_t::resetAdjustment() noexcept
+	{
+		if (adjustment)
+			adjustment->store(0, std::memory_order_relaxed);
+	}
+
+	resultCounter_t &resultCounter_t::operator +=(const uint32_t count) noexcept
+	{
+		(results.shard().*counter).fetch_add(count, std::memory_order_relaxed);
+		return *this;
+	}
+
+	resultCounter_t &resultCounter_t::operator -=(const uint32_t count) noexcept
+	{
+		(results.shard().*counter).fetch_sub(count, std::memory_order_relaxed);
+		return *this;
+	}
+} // namespace crunch
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef RESULTS__HXX
+#define RESULTS__HXX
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// The size of cache line we pad to - right for x86 and most ARM parts, and the adjacent line
+	// prefetch on those that pair lines up only costs us a little sharing
+	constexpr static std::size_t cacheLineSize{64};
+
+	// One thread's share of a run's results, padded out to a cache line of its own so threads
+	// counting results side by side never bounce a line between them
+	struct alignas(cacheLineSize) resultShard_t final
+	{
+		std::atomic<uint32_t> passes{0};
+		std::atomic<uint32_t> failures{0};
+	};
+
+	struct testResults_t;
+
+	// One of the counts kept by a testResults_t. Counting goes to the calling thread's shard,
+	// while reading sums the count over every shard in use, plus any adjustment made to it from outside
+	struct resultCounter_t final
+	{
+	private:
+		testResults_t &results;
+		std::atomic<uint32_t> resultShard_t::*counter;
+		std::atomic<uint32_t> *adjustment;
+
+	public:
+		constexpr resultCounter_t(testResults_t &results_, std::atomic<uint32_t> resultShard_t::*const counter_,
+			std::atomic<uint32_t> *const adjustment_ = nullptr) noexcept :
+			results{results_}, counter{counter_}, adjustment{adjustment_} { }
+		resultCounter_t(const resultCounter_t &) = delete;
+		resultCounter_t(resultCounter_t &&) = delete;
+		~resultCounter_t() noexcept = default;
+		resultCounter_t &operator =(const resultCounter_t &) = delete;
+		resultCounter_t &operator =(resultCounter_t &&) = delete;
+
+		CRUNCH_VIS uint32_t load() const noexcept;
+		operator uint32_t() const noexcept { return load(); } // NOLINT(google-explicit-constructor)
+		CRUNCH_VIS resultCounter_t &operator +=(uint32_t count) noexcept;
+		CRUNCH_VIS resultCounter_t &operator -=(uint32_t count) noexcept;
+		resultCounter_t &operator ++() noexcept { return *this += 1U; }
+		resultCounter_t &operator --() noexcept { return *this -= 1U; }
+		// Zeros the adjustment, if this count has one
+		CRUNCH_VIS void resetAdjustment() noexcept;
+	};
+
+	// The results of a run, counted into a shard per thread that are only merged when read, so tests
+	// running in parallel never contend over them. Shards are handed out to threads as they first
+	// count a result, and only once there are more than maxShards threads do any share one.
+	struct testResults_t final
+	{
+	private:
+		constexpr static std::size_t maxShards{64};
+		std::array<resultShard_t, maxShards> shards{};
+
+	public:
+		resultCounter_t passes{*this, &resultShard_t::passes};
+		resultCounter_t failures{*this, &resultShard_t::failures};
+
+		testResults_t() noexcept = default;
+		// Results whose counts also take in whatever is added to or taken from the given counters directly
+		testResults_t(std::atomic<uint32_t> &passesAdjustment, std::atomic<uint32_t> &failuresAdjustment) noexcept :
+			passes{*this, &resultShard_t::passes, &passesAdjustment},
+			failures{*this, &resultShard_t::failures, &failuresAdjustment} { }
+		testResults_t(const testResults_t &) = delete;
+		testResults_t(testResults_t &&) = delete;
+		~testResults_t() noexcept = default;
+		testResults_t &operator =(const testResults_t &) = delete;
+		testResults_t &operator =(testResults_t &&) = delete;
+
+		// The calling thread's shard
+		resultShard_t &shard() noexcept;
+		uint32_t sum(std::atomic<uint32_t> resultShard_t::*counter) const noexcept;
+		uint64_t total() const noexcept { return uint64_t{passes} + failures; }
+		// Zeros the counts, for a new run. Nothing may be counting at the time
+		CRUNCH_VIS void reset() noexcept;
+	};
+
+	// The results of the run
+	CRUNCHpp_API testResults_t results;
+	// The counters test libraries built before the results were sharded adjust directly, and which
+	// remain for them as they were. They only hold what was adjusted through them, which the run's
+	// results then take in, so to read the counts use results.passes and results.failures.
+	CRUNCHpp_API std::atomic<uint32_t> passes, failures;
+} // namespace crunch
+
+#endif /*RESULTS__HXX*/
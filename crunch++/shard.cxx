@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
+#include <string>
+#include "shard.hxx"
+#include "history.hxx"
+
+namespace crunch
+{
+	uint32_t shardIndex = 0;
+	uint32_t shardCount = 1;
+	bool shardLibraries = false;
+	const testHistory_t *shardTimings{nullptr};
+
+	// FNV-1a, so every machine hashes a name the same way regardless of platform or standard library
+	static uint64_t hashName(const std::string &name) noexcept
+	{
+		uint64_t hash{UINT64_C(0xcbf29ce484222325)};
+		for (const auto chr : name)
+		{
+			hash ^= uint8_t(chr);
+			hash *= UINT64_C(0x100000001b3);
+		}
+		return hash;
+	}
+
+	// Shares the items out between the shards. Those with a known duration are dealt longest first to the
+	// least loaded shard, with ties going to the first shard counting round from salt, so the shards come
+	// out balanced by time. Those without are placed by their hash. Every input is the same on every
+	// machine given the same tests and shard timings, so the shards are too.
+	static std::vector<uint32_t> assignShards(const std::vector<uint64_t> &durations,
+		const std::vector<uint64_t> &hashes, const uint64_t salt)
+	{
+		std::vector<uint32_t> shards(durations.size());
+		std::vector<std::size_t> order{};
+		for (std::size_t i{0}; i < durations.size(); ++i)
+		{
+			if (durations[i] == testHistory_t::unknownDuration)
+				shards[i] = uint32_t(hashes[i] % shardCount);
+			else
+				order.push_back(i);
+		}
+		std::sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b)
+		{
+			if (durations[a] != durations[b])
+				return durations[a] > durations[b];
+			return hashes[a] != hashes[b] ? hashes[a] < hashes[b] : a < b;
+		});
+
+		std::vector<uint64_t> loads(shardCount);
+		for (const auto index : order)
+		{
+			auto shard{uint32_t(salt % shardCount)};
+			for (uint32_t i{1}; i < shardCount; ++i)
+			{
+				const auto candidate{uint32_t((salt + i) % shardCount)};
+				if (loads[candidate] < loads[shard])
+					shard = candidate;
+			}
+			loads[shard] += durations[index];
+			shards[index] = shard;
+		}
+		return shards;
+	}
+
+	std::vector<uint32_t> shardsForLibraries(const std::vector<const char *> &libraries)
+	{
+		std::vector<uint64_t> durations(libraries.size(), testHistory_t::unknownDuration);
+		std::vector<uint64_t> hashes(libraries.size());
+		for (std::size_t i{0}; i < libraries.size(); ++i)
+		{
+			if (shardTimings)
+				durations[i] = shardTimings->libraryDuration(libraries[i]);
+			hashes[i] = hashName(libraries[i]);
+		}
+		return assignShards(durations, hashes, 0);
+	}
+
+	void selectShard(std::vector<internal::cxxTest> &tests)
+	{
+		if (shardCount < 2 || shardLibraries)
+			return;
+		const auto *const library{currentLibrary()};
+		const auto *const suite{currentSuite()};
+		std::string prefix{library ? library : ""};
+		prefix += '\t';
+		prefix += suite ? suite : "";
+		prefix += '\t';
+
+		std::vector<uint64_t> durations(tests.size(), testHistory_t::unknownDuration);
+		std::vector<uint64_t> hashes(tests.size());
+		for (std::size_t i{0}; i < tests.size(); ++i)
+		{
+			if (shardTimings && library && suite)
+				durations[i] = shardTimings->duration(library, suite, tests[i].name());
+			hashes[i] = hashName(prefix + tests[i].name());
+		}
+		// Salting with the suite stops the longest test of every small suite landing on the same shard
+		const auto shards{assignShards(durations, hashes, hashName(prefix))};
+
+		std::size_t kept{0};
+		for (std::size_t i{0}; i < tests.size(); ++i)
+		{
+			if (shards[i] != shardIndex)
+				continue;
+			// Moving a test onto itself isn't safe for every member type, so only move those that shift down
+			if (kept != i)
+				tests[kept] = std::move(tests[i]);
+			++kept;
+		}
+		tests.erase(tests.begin() + std::ptrdiff_t(kept), tests.end());
+	}
+} // namespace crunch
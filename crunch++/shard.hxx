@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef SHARD__HXX
+#define SHARD__HXX
+
+#include <cstdint>
+#include <vector>
+#include "crunch++.h"
+
+namespace crunch
+{
+	struct testHistory_t;
+
+	// Which of shardCount machines this run is (counting from 0), or 0 of 1 when not sharding
+	CRUNCHpp_API uint32_t shardIndex;
+	CRUNCHpp_API uint32_t shardCount;
+	// Whether to shard by whole test library rather than by test
+	CRUNCHpp_API bool shardLibraries;
+	// The timings the shards are balanced by, or nullptr to place tests by the hashes of their names alone.
+	// Every shard must be given the same timings, or they would split the tests up differently, so
+	// these only ever come from an explicitly given --shard-timings file and never the local --history.
+	CRUNCHpp_API const testHistory_t *shardTimings;
+
+	// Returns which shard each of the given test libraries belongs to
+	CRUNCHpp_API std::vector<uint32_t> shardsForLibraries(const std::vector<const char *> &libraries);
+	// Drops the tests of the suite being run that belong to other shards
+	void selectShard(std::vector<internal::cxxTest> &tests);
+} // namespace crunch
+
+#endif /*SHARD__HXX*/
@@ -1,13 +1,44 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
-#include <future>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <substrate/utility>
 #include "crunch++.h"
 #include "core.hxx"
 #include "logger.hxx"
+#include "workerPool.hxx"
+#include "isolation.hxx"
+#include "history.hxx"
+#include "timing.hxx"
+#include "shard.hxx"
+#include "filter.hxx"
+#include "capture.hxx"
+#include "output.hxx"
+#include "reporter.hxx"
+#include "expectations.hxx"
 
 namespace crunch
 {
 	bool loggingTests = false;
+	bool listingTests{false};
+	uint32_t testJobs = 1;
 	std::vector<cxxTestClass> cxxTests;
+	static thread_local std::vector<cxxTestClass> *registeringInto{nullptr};
+	static thread_local std::vector<notedTest_t> *notingInto{nullptr};
+	static std::mutex exceptionsLock;
+
+	struct testResult_t final
+	{
+		std::string output{};
+		int32_t result{0};
+		std::exception_ptr error{};
+		testTiming_t timing{};
+		testReport_t report{};
+		// Whether the test was run, and if so, whether it failed
+		bool ran{false};
+		bool failed{false};
+		bool complete{false};
+	};
 
 	void newline()
 	{
@@ -23,6 +54,44 @@ namespace crunch
 		else
 			testPrintf(" ");
 	}
+
+	// Ends the run once it has failed as many times as --max-failures allows
+	static void checkFailureLimit()
+	{
+		if (failureLimitReached())
+			throw threadExit_t{1};
+	}
+
+	// Prints the tests of the suite being run that would have been run, one per line as "library: Suite::test"
+	static void listTests(const std::vector<internal::cxxTest> &tests)
+	{
+		const auto *const library{currentLibrary()};
+		const auto *const suite{currentSuite()};
+		const auto suiteName{suite ? substrate::decode_typename(suite) : std::string{}};
+		for (const auto &test : tests)
+			testPrintf("%s: %s::%s\n", library ? library : "", suiteName.c_str(), test.name());
+	}
+
+	bool listNotedTests(const char *const library, const char *const suite, const std::vector<notedTest_t> &tests)
+	{
+		std::vector<internal::cxxTest> suiteTests{};
+		std::vector<const char *> tags{};
+		for (const auto &test : tests)
+		{
+			if (strcmp(test.suite, suite) != 0)
+				continue;
+			suiteTests.emplace_back(std::function<void ()>{}, test.test);
+			tags.emplace_back(test.tags);
+		}
+		if (suiteTests.empty())
+			return false;
+		historyContext(library, suite);
+		selectFiltered(suiteTests, tags);
+		selectShard(suiteTests);
+		listTests(suiteTests);
+		historyContext(nullptr, nullptr);
+		return true;
+	}
 }
 
 #ifdef _WIN32
@@ -36,23 +105,50 @@ using crunch::logger;
 using crunch::logResult;
 using crunch::RESULT_SUCCESS;
 using crunch::RESULT_FAILURE;
-using crunch::failures;
 using crunch::echoAborted;
+using crunch::captureOutput;
+using crunch::capturingOutput;
 
-int32_t testsuite::testRunner(testsuite &unitClass, crunch::internal::cxxTest &unitTest)
+namespace crunch
 {
-	if (isTTY)
+	static void printTestName(const internal::cxxTest &unitTest)
+	{
+		if (isTTY)
 #ifndef _WIN32
-		testPrintf(INFO);
+			testPrintf(INFO);
 #else
-		SetConsoleTextAttribute(console, FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY);
+			SetConsoleTextAttribute(console, FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY);
 #endif
-	testPrintf("%s...", unitTest.name());
-	newline();
+		testPrintf("%s...", unitTest.name());
+		newline();
+		syncOutput();
+	}
+} // namespace crunch
+
+int32_t testsuite::testRunner(testsuite &unitClass, crunch::internal::cxxTest &unitTest)
+{
+	crunch::printTestName(unitTest);
+	auto &timing{crunch::lastTestTiming()};
+	const auto failuresBefore{crunch::threadFailures()};
+	crunch::discardExpectations();
+	// What the test writes to stdout and stderr is only shown if it fails
+	const auto capturing{crunch::beginCapture()};
+	const auto replayCapture = [&]()
+	{
+		if (!capturing)
+			return;
+		const auto output{crunch::endCapture()};
+		if (crunch::threadFailures() != failuresBefore)
+			testPrintf("%s", crunch::formatCapture(output).c_str());
+	};
+	const crunch::stopwatch_t stopwatch{};
 	try
-		{ unitTest.function()(); }
+		{ unitTest.run(unitClass); }
 	catch (threadExit_t &val)
 	{
+		timing = stopwatch.elapsed();
+		crunch::reportExpectations(crunch::threadFailures() != failuresBefore);
+		replayCapture();
 		// Did the test switch logging on?
 		if (!loggingTests && logger)
 			// Yes, switch it back off again
@@ -61,63 +157,288 @@ int32_t testsuite::testRunner(testsuite &unitClass, crunch::internal::cxxTest &u
 	}
 	catch (...)
 	{
-		unitClass.exceptions.emplace_back(std::current_exception());
+		timing = stopwatch.elapsed();
+		{
+			std::lock_guard<std::mutex> lock{crunch::exceptionsLock};
+			unitClass.exceptions.emplace_back(std::current_exception());
+		}
 		// Did the test switch logging on?
 		if (!loggingTests && logger)
 			// Yes, switch it back off again
 			stopLogging(logger);
 		logResult(RESULT_FAILURE, "Failure: Exception caught by crunch++");
+		crunch::reportExpectations(true);
+		replayCapture();
 #ifndef _WIN32
 		testPrintf(CURS_UP);
 #endif
 		return 2;
 	}
+	timing = stopwatch.elapsed();
+	// Expectations that failed let the test run on to its end, so it's only now that it fails
+	const auto expectationsFailed{crunch::reportExpectations(false)};
+	replayCapture();
 	// Did the test switch logging on?
 	if (!loggingTests && logger)
 		// Yes, switch it back off again
 		stopLogging(logger);
-	logResult(RESULT_SUCCESS, "");
+	if (expectationsFailed)
+		return 1;
+	crunch::logOk(timing);
 	return 0;
 }
 
 void testsuite::test()
 {
-	for (auto &unitTest : tests)
+	crunch::selectFiltered(*this, tests);
+	crunch::selectShard(tests);
+	if (crunch::listingTests)
 	{
-		std::promise<int32_t> resultPromise{};
-		auto result = resultPromise.get_future();
-		std::thread testThread{
-			[](testsuite &suite, crunch::internal::cxxTest &test, std::promise<int32_t> result)
+		crunch::listTests(tests);
+		return;
+	}
+	crunch::failuresFirst(tests);
+	const auto timeouts{crunch::timeoutsFor(*this)};
+#ifndef _WIN32
+	// Tests can only be stopped when they overrun by running them in worker processes
+	if (crunch::isolateTests || timeouts.test || timeouts.suite)
+#else
+	if (crunch::isolateTests)
+#endif
+	{
+		// Report each test as soon as it and all those registered before it have completed
+		std::vector<crunch::isolatedResult_t> results(tests.size());
+		std::size_t reported{0};
+		const auto report = [&](const std::size_t)
+		{
+			for (; reported < results.size() && results[reported].complete; ++reported)
 			{
-				try
-					{ result.set_value(testRunner(suite, test)); }
-				catch (...)
-					{ result.set_exception(std::current_exception()); }
-			}, std::ref(*this), std::ref(unitTest), std::move(resultPromise)
+				const auto &result{results[reported]};
+				if (result.result == crunch::isolatedNotRun)
+					continue;
+				crunch::recordTiming(tests[reported], result.timing);
+				crunch::recordOutcome(tests[reported], result.crashed || result.failures || result.result < 0);
+				// What we log here of how the test went is added to what the worker reported of it
+				auto &report{crunch::threadReport()};
+				report = result.report;
+				if (result.crashed)
+				{
+					crunch::printTestName(tests[reported]);
+					crunch::logCrash(result.waitStatus);
+				}
+				else if (result.result == crunch::isolatedSuiteTimedOut)
+				{
+					crunch::printTestName(tests[reported]);
+					logResult(RESULT_FAILURE, "Failure: Suite timed out before the test could run");
+				}
+				else
+				{
+					if (!result.output.empty())
+						testPrintf("%s", result.output.c_str());
+					if (result.result == crunch::isolatedTimedOut)
+					{
+						// If the worker couldn't report back, we don't even have the test's name from it
+						if (result.output.empty())
+							crunch::printTestName(tests[reported]);
+						logResult(RESULT_FAILURE, "Failure: Test timed out after %s",
+							crunch::formatDuration(result.timing.wallTime).c_str());
+					}
+					else if (result.result == crunch::isolatedErrorOutsideTest)
+						logResult(RESULT_FAILURE, "Failure: Exception caught by crunch++ outside test");
+				}
+				crunch::reportTest(tests[reported], result.crashed || result.result < 0 ||
+					(result.result && !report.skipped), result.timing, report);
+				if (result.result == crunch::isolatedErrorOutsideTest)
+				{
+					--crunch::results.failures;
+					echoAborted();
+				}
+				else if (result.result == 2)
+					echoAborted();
+			}
+			crunch::syncOutput();
 		};
-		testThread.join();
+		if (crunch::runIsolated(results, crunch::scheduleOrder(tests), crunch::testJobs, timeouts,
+				[this](const std::size_t index) { return testRunner(*this, tests[index]); }, report))
+		{
+			crunch::checkFailureLimit();
+			return;
+		}
+		testPrintf("Could not start worker processes, running tests in-process");
+		newline();
+	}
+
+	// If the runner hasn't provided a pool of workers, make a single one just for this suite
+	std::unique_ptr<crunch::workerPool_t> localWorkers{};
+	if (!crunch::testWorkers)
+		localWorkers = crunch::makeUnique<crunch::workerPool_t>(1U);
+	auto &workers{crunch::testWorkers ? *crunch::testWorkers : *localWorkers};
+
+	// When tests can run concurrently, each test's output is captured by the worker running
+	// it and replayed here in registration order so the output reads exactly as a serial run's
+	// would. Otherwise tests are handed over one at a time and print straight to the console,
+	// unless our own output is being captured, in which case theirs must be too.
+	const auto count{tests.size()};
+	const bool parallel{workers.size() > 1 && count > 1};
+	const bool capture{parallel || capturingOutput()};
+	std::vector<crunch::testResult_t> results(count);
+	std::mutex resultsLock{};
+	std::condition_variable resultReady{};
+	std::size_t outstanding{0};
+	std::atomic<bool> aborting{false};
+
+	const auto submit = [&](const std::size_t index)
+	{
+		{
+			std::lock_guard<std::mutex> lock{resultsLock};
+			++outstanding;
+		}
+		// If the test can't be queued it will never run to count itself done, so take it back off here
 		try
 		{
-			if (result.get() == 2)
-				echoAborted();
+			workers.submit([&, index]()
+			{
+				auto &result{results[index]};
+				// Once the run has failed enough, the tests yet to start are left unrun
+				if (!aborting && !crunch::failureLimitReached())
+				{
+					if (capture)
+						captureOutput(&result.output);
+					crunch::lastTestTiming() = {};
+					crunch::threadReport() = {};
+					const auto failuresBefore{crunch::threadFailures()};
+					try
+						{ result.result = testRunner(*this, tests[index]); }
+					catch (...)
+						{ result.error = std::current_exception(); }
+					result.timing = crunch::lastTestTiming();
+					result.report = std::move(crunch::threadReport());
+					result.ran = true;
+					result.failed = result.error || crunch::threadFailures() != failuresBefore;
+					if (capture)
+						captureOutput(nullptr);
+				}
+				// Notify under the lock as the waiter owns everything here and may return as soon as it wakes
+				std::lock_guard<std::mutex> lock{resultsLock};
+				result.complete = true;
+				--outstanding;
+				resultReady.notify_all();
+			});
 		}
 		catch (...)
 		{
-			logResult(RESULT_FAILURE, "Failure: Exception caught by crunch++ outside test");
-			--failures;
-			echoAborted();
+			std::lock_guard<std::mutex> lock{resultsLock};
+			--outstanding;
+			throw;
+		}
+	};
+
+#ifdef _WIN32
+	// Console colouring is applied out-of-band on Windows, so can't be replayed from a buffer
+	const auto wasTTY{isTTY};
+	if (parallel && wasTTY)
+		isTTY = false;
+#endif
+	// Make sure no worker is still running one of our tests by the time we return or unwind
+	const auto finish = [&]()
+	{
+		aborting = true;
+		std::unique_lock<std::mutex> lock{resultsLock};
+		resultReady.wait(lock, [&]() { return !outstanding; });
+#ifdef _WIN32
+		if (parallel && wasTTY)
+			isTTY = true;
+#endif
+	};
+
+	try
+	{
+		if (parallel)
+		{
+			// Start the tests expected to take longest first so they don't hold up the end of the run
+			for (const auto index : crunch::scheduleOrder(tests))
+				submit(index);
+		}
+
+		for (std::size_t i{0}; i < count; ++i)
+		{
+			auto &result{results[i]};
+			if (!parallel)
+				submit(i);
+			{
+				std::unique_lock<std::mutex> lock{resultsLock};
+				resultReady.wait(lock, [&]() { return result.complete; });
+			}
+			if (result.ran)
+			{
+				crunch::recordTiming(tests[i], result.timing);
+				crunch::recordOutcome(tests[i], result.failed);
+				if (result.error)
+					result.report.message = "Exception caught by crunch++ outside test";
+				// Tests may log failures they then take back, so go by how the test ended
+				crunch::reportTest(tests[i], result.error || (result.result && !result.report.skipped),
+					result.timing, result.report);
+			}
+			if (!result.output.empty())
+			{
+				testPrintf("%s", result.output.c_str());
+				crunch::syncOutput();
+			}
+			if (result.error)
+			{
+				logResult(RESULT_FAILURE, "Failure: Exception caught by crunch++ outside test");
+				--crunch::results.failures;
+				echoAborted();
+			}
+			else if (result.result == 2)
+				echoAborted();
 		}
 	}
+	catch (...)
+	{
+		finish();
+		throw;
+	}
+	finish();
+	crunch::checkFailureLimit();
 }
 
-bool testsuite::registerTest(std::function<void ()> &&func, const char *const name) try
+bool testsuite::registerMacroTest(std::function<void ()> &&func, const char *const name, const char *const tags) try
 {
+	if (tags)
+		crunch::setTags(*this, name, tags);
 	tests.emplace_back(std::move(func), name);
 	return true;
 }
 catch (std::exception &)
 	{ return false; }
 
+#ifndef CRUNCHpp_MANIFEST
+bool testsuite::registerTest(std::function<void ()> &&func, const char *const name)
+	{ return registerMacroTest(std::move(func), name, nullptr); }
+
+bool testsuite::registerTest(std::function<void ()> &&func, const char *const name, const char *const tags)
+	{ return registerMacroTest(std::move(func), name, tags); }
+#endif
+
+bool testsuite::registerTestTable(const crunch::internal::testEntry_t *const table, const std::size_t count) try
+{
+	tests.reserve(tests.size() + count);
+	for (std::size_t i{0}; i < count; ++i)
+		tests.emplace_back(table[i]);
+	return true;
+}
+catch (std::exception &)
+	{ return false; }
+
+bool testsuite::reserveTests(const std::size_t count) try
+{
+	tests.reserve(tests.size() + count);
+	return true;
+}
+catch (std::exception &)
+	{ return false; }
+
 namespace crunch
 {
 	namespace internal
@@ -125,7 +446,30 @@ namespace crunch
 		cxxTest::cxxTest(std::function<void ()> &&func, const char *const name) noexcept :
 			testFunc{std::move(func)}, testName{name} { }
 
+		cxxTest::cxxTest(const testEntry_t &tableEntry) noexcept : testName{tableEntry.name}, entry{&tableEntry} { }
+
 		void registerTestClass(std::unique_ptr<testsuite> &&suite, const char *name)
-			{ cxxTests.emplace_back(std::move(suite), name); }
+			{ (registeringInto ? *registeringInto : cxxTests).emplace_back(std::move(suite), name); }
+
+		void registerTestClass(const suiteFactory_t factory, const char *name)
+			{ (registeringInto ? *registeringInto : cxxTests).emplace_back(factory, name); }
+
+		void noteTest(const char *const suite, const char *const test, const char *const tags) noexcept try
+		{
+			if (notingInto)
+				notingInto->push_back({suite, test, tags});
+		}
+		catch (std::bad_alloc &)
+		{
+			// Noting only some of a library's tests would list only some of them, so note none
+			notingInto->clear();
+			notingInto = nullptr;
+		}
 	}
+
+	void registrationContext(std::vector<cxxTestClass> *const context) noexcept
+		{ registeringInto = context; }
+
+	void notingContext(std::vector<notedTest_t> *const context) noexcept
+		{ notingInto = context; }
 }
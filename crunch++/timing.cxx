@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+#include "timing.hxx"
+#include "core.hxx"
+#include "logger.hxx"
+#include "history.hxx"
+
+namespace crunch
+{
+	struct slowTest_t final
+	{
+		std::string name;
+		testTiming_t timing;
+	};
+
+	// How many of the slowest tests printSlowest() reports
+	constexpr static std::size_t slowestCount{5};
+	static std::vector<slowTest_t> slowest{};
+	static std::mutex slowestLock{};
+
+	uint64_t threadCPUTime() noexcept
+	{
+#ifndef _WIN32
+		timespec time{};
+		if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time))
+			return 0;
+		return uint64_t(time.tv_sec) * 1000000000U + uint64_t(time.tv_nsec);
+#else
+		FILETIME creation{};
+		FILETIME exit{};
+		FILETIME kernel{};
+		FILETIME user{};
+		if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+			return 0;
+		// FILETIMEs count in units of 100ns
+		const auto toNanoseconds = [](const FILETIME &time) noexcept
+			{ return ((uint64_t(time.dwHighDateTime) << 32U) | time.dwLowDateTime) * 100U; };
+		return toNanoseconds(kernel) + toNanoseconds(user);
+#endif
+	}
+
+	stopwatch_t::stopwatch_t() noexcept : wallStart{std::chrono::steady_clock::now()}, cpuStart{threadCPUTime()} { }
+
+	testTiming_t stopwatch_t::elapsed() const noexcept
+		{ return {nanosecondsSince(wallStart), threadCPUTime() - cpuStart}; }
+
+	std::string formatDuration(const uint64_t duration)
+	{
+		std::array<char, 32> result{};
+		if (duration < 1000U)
+			snprintf(result.data(), result.size(), "%uns", unsigned(duration));
+		else if (duration < 1000000U)
+			snprintf(result.data(), result.size(), "%.2fus", double(duration) / 1e3);
+		else if (duration < 1000000000U)
+			snprintf(result.data(), result.size(), "%.2fms", double(duration) / 1e6);
+		else
+			snprintf(result.data(), result.size(), "%.2fs", double(duration) / 1e9);
+		return result.data();
+	}
+
+	std::string formatTiming(const testTiming_t &timing)
+		{ return formatDuration(timing.wallTime) + " wall, " + formatDuration(timing.cpuTime) + " CPU"; }
+
+	testTiming_t &lastTestTiming() noexcept
+	{
+		static thread_local testTiming_t timing{};
+		return timing;
+	}
+
+	void recordTiming(const internal::cxxTest &test, const testTiming_t &timing)
+	{
+		recordDuration(test, timing.wallTime);
+		auto name{qualifiedName(test)};
+		// When the runner is logging, stdout is the log file
+		if (loggingTests && logger)
+			fprintf(stdout, "%s took %s\n", name.c_str(), formatTiming(timing).c_str());
+
+		std::lock_guard<std::mutex> lock{slowestLock};
+		// slowest is kept sorted longest first, so only a test slower than the last entry can make the list
+		if (slowest.size() == slowestCount && timing.wallTime <= slowest.back().timing.wallTime)
+			return;
+		const auto position{std::find_if(slowest.begin(), slowest.end(),
+			[&](const slowTest_t &entry) { return timing.wallTime > entry.timing.wallTime; })};
+		slowest.insert(position, {std::move(name), timing});
+		if (slowest.size() > slowestCount)
+			slowest.pop_back();
+	}
+
+	void forgetSlowest()
+	{
+		std::lock_guard<std::mutex> lock{slowestLock};
+		slowest.clear();
+	}
+
+	void printSlowest()
+	{
+		std::lock_guard<std::mutex> lock{slowestLock};
+		if (slowest.empty())
+			return;
+		testPrintf("Slowest tests:\n");
+		for (const auto &entry : slowest)
+			testPrintf("\t%s: %s\n", entry.name.c_str(), formatTiming(entry.timing).c_str());
+	}
+} // namespace crunch
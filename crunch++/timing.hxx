@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef TIMING__HXX
+#define TIMING__HXX
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// How long a test took by the wall clock and in CPU time used by the thread running it, in nanoseconds
+	struct testTiming_t final
+	{
+		uint64_t wallTime;
+		uint64_t cpuTime;
+	};
+
+	// Measures the wall and thread CPU time that has passed since it was constructed
+	struct stopwatch_t final
+	{
+	private:
+		std::chrono::steady_clock::time_point wallStart;
+		uint64_t cpuStart;
+
+	public:
+		stopwatch_t() noexcept;
+		testTiming_t elapsed() const noexcept;
+	};
+
+	uint64_t threadCPUTime() noexcept;
+	// Formats a duration in nanoseconds with units chosen to keep it short, eg "1.25ms"
+	std::string formatDuration(uint64_t duration);
+	std::string formatTiming(const testTiming_t &timing);
+
+	// The timing of the test last run by testsuite::testRunner() on the calling thread
+	testTiming_t &lastTestTiming() noexcept;
+	// Records the timing of a test that has completed for the run's log and statistics
+	void recordTiming(const internal::cxxTest &test, const testTiming_t &timing);
+	// Prints the tests that took longest by the wall clock over the run so far, if any
+	CRUNCHpp_API void printSlowest();
+	// Starts over on the slowest tests, for a new run
+	CRUNCHpp_API void forgetSlowest();
+} // namespace crunch
+
+#endif /*TIMING__HXX*/
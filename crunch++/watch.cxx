@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <array>
+#include <cerrno>
+#include <set>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#include "watch.hxx"
+
+namespace crunch
+{
+#ifdef __linux__
+	const bool watchSupported{true};
+#else
+	const bool watchSupported{false};
+#endif
+	bool watchingLibraries{false};
+
+#ifdef __linux__
+	// How long a library must go without being written to before we take its rebuild to be done,
+	// in milliseconds, as linkers and build systems may write a file more than once
+	constexpr static int32_t settleTime{100};
+
+	libraryWatcher_t::libraryWatcher_t() noexcept : fd{inotify_init1(IN_CLOEXEC)} { }
+
+	libraryWatcher_t::~libraryWatcher_t() noexcept
+	{
+		if (fd != -1)
+			close(fd);
+	}
+
+	bool libraryWatcher_t::watch(const std::size_t index, const std::string &path)
+	{
+		const auto slash{path.rfind('/')};
+		const auto directory{slash == std::string::npos ? std::string{"."} :
+			slash == 0 ? std::string{"/"} : path.substr(0, slash)};
+		// Watching the directory rather than the file sees a new file being moved in over the old one
+		const auto watch{inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO)};
+		if (watch == -1)
+			return false;
+		libraries.push_back({index, watch, slash == std::string::npos ? path : path.substr(slash + 1)});
+		return true;
+	}
+
+	std::vector<std::size_t> libraryWatcher_t::wait() const
+	{
+		std::set<std::size_t> written{};
+		// Block until a library is written, then only until the writes stop coming
+		int32_t timeout{-1};
+		alignas(inotify_event) std::array<char, 4096> buffer{};
+		while (true)
+		{
+			pollfd events{fd, POLLIN, 0};
+			const auto result{poll(&events, 1, timeout)};
+			if (result == -1)
+			{
+				if (errno == EINTR)
+					continue;
+				return {};
+			}
+			else if (!result)
+				break;
+			const auto length{read(fd, buffer.data(), buffer.size())};
+			if (length <= 0)
+				return {};
+			for (ssize_t offset{0}; offset < length;)
+			{
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				const auto &event{*reinterpret_cast<const inotify_event *>(buffer.data() + offset)};
+				offset += ssize_t(sizeof(inotify_event) + event.len);
+				if (!event.len)
+					continue;
+				for (const auto &library : libraries)
+				{
+					if (library.directory == event.wd && library.fileName == event.name)
+						written.insert(library.index);
+				}
+			}
+			if (!written.empty())
+				timeout = settleTime;
+		}
+		return {written.begin(), written.end()};
+	}
+#else
+	libraryWatcher_t::libraryWatcher_t() noexcept = default;
+	libraryWatcher_t::~libraryWatcher_t() noexcept = default;
+	bool libraryWatcher_t::watch(const std::size_t, const std::string &) { return false; }
+	std::vector<std::size_t> libraryWatcher_t::wait() const { return {}; }
+#endif
+} // namespace crunch
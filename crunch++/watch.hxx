@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef WATCH__HXX
+#define WATCH__HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// Whether --watch can be honoured on this platform
+	CRUNCHpp_API const bool watchSupported;
+	// Whether the runner is watching the test libraries, so must unload each once it has been run
+	// for a rebuilt copy to be loaded in its place next time
+	CRUNCHpp_API bool watchingLibraries;
+
+	// Watches the directories holding a set of test libraries for the libraries being written, as
+	// a rebuild does either in place or by moving a new file over the old one
+	struct libraryWatcher_t final
+	{
+	private:
+		struct library_t final
+		{
+			std::size_t index;
+			int32_t directory;
+			std::string fileName;
+		};
+
+		int32_t fd{-1};
+		std::vector<library_t> libraries{};
+
+	public:
+		CRUNCH_VIS libraryWatcher_t() noexcept;
+		libraryWatcher_t(const libraryWatcher_t &) = delete;
+		libraryWatcher_t(libraryWatcher_t &&) = delete;
+		CRUNCH_VIS ~libraryWatcher_t() noexcept;
+		libraryWatcher_t &operator =(const libraryWatcher_t &) = delete;
+		libraryWatcher_t &operator =(libraryWatcher_t &&) = delete;
+
+		bool valid() const noexcept { return fd != -1; }
+		// Watches the library at path, which need not exist yet, reporting it by the index given
+		CRUNCH_VIS bool watch(std::size_t index, const std::string &path);
+		// Waits for one or more of the libraries to be written, and then for the writes to settle.
+		// Returns the indices of the libraries written in ascending order, or none if watching failed.
+		CRUNCH_VIS std::vector<std::size_t> wait() const;
+	};
+} // namespace crunch
+
+#endif /*WATCH__HXX*/
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "workerPool.hxx"
+
+namespace crunch
+{
+	workerPool_t *testWorkers{nullptr};
+
+	workerPool_t::workerPool_t(const std::size_t count) :
+		queues{makeUnique<taskQueue_t []>(count)}
+	{
+		workers.reserve(count);
+		try
+		{
+			for (std::size_t i{0}; i < count; ++i)
+				workers.emplace_back([this, i]() { worker(i); });
+		}
+		catch (...)
+		{
+			// The destructor won't run for a partially constructed pool, so clean up here
+			stop();
+			throw;
+		}
+	}
+
+	workerPool_t::~workerPool_t() noexcept
+		{ stop(); }
+
+	void workerPool_t::stop() noexcept
+	{
+		{
+			std::lock_guard<std::mutex> lock{idleLock};
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto &workerThread : workers)
+			workerThread.join();
+		workers.clear();
+	}
+
+	void workerPool_t::submit(std::function<void ()> &&task)
+	{
+		// Deal tasks out round-robin so each queue holds a similar mix of long and short ones
+		std::lock_guard<std::mutex> lock{idleLock};
+		{
+			auto &queue{queues[nextQueue]};
+			std::lock_guard<std::mutex> queueLock{queue.lock};
+			queue.tasks.emplace_back(std::move(task));
+		}
+		nextQueue = (nextQueue + 1) % workers.size();
+		++pending;
+		wake.notify_one();
+	}
+
+	// Takes the next task from our own queue, or failing that from the front of another worker's
+	// queue, which holds the task that would have been started soonest
+	bool workerPool_t::take(const std::size_t self, std::function<void ()> &task) noexcept
+	{
+		const auto count{workers.size()};
+		for (std::size_t i{0}; i < count; ++i)
+		{
+			auto &queue{queues[(self + i) % count]};
+			std::lock_guard<std::mutex> lock{queue.lock};
+			if (!queue.tasks.empty())
+			{
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void workerPool_t::worker(const std::size_t self) noexcept
+	{
+		std::function<void ()> task{};
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock{idleLock};
+				wake.wait(lock, [this]() { return stopping || pending; });
+				// Drain anything still queued before honouring a stop request
+				if (!pending)
+					return;
+				--pending;
+			}
+			// Having claimed one of the pending tasks, there is always one for us to find, though
+			// another claimant may beat us to the queue we first look in
+			while (!take(self, task))
+				continue;
+			task();
+			task = nullptr;
+		}
+	}
+} // namespace crunch
@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef WORKER_POOL__HXX
+#define WORKER_POOL__HXX
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include "crunch++.h"
+
+namespace crunch
+{
+	// A set of long-lived runner threads, each with its own queue of tasks, so running a test costs
+	// a queue hand-off rather than a thread create and join. Tasks are dealt out to the queues in
+	// the order submitted and a worker whose queue runs dry steals from the others, which keeps
+	// every worker busy until the last task has been started.
+	struct workerPool_t final
+	{
+	private:
+		struct taskQueue_t final
+		{
+			std::mutex lock{};
+			std::deque<std::function<void ()>> tasks{};
+		};
+
+		std::vector<std::thread> workers{};
+		std::unique_ptr<taskQueue_t []> queues{};
+		std::size_t nextQueue{0};
+		// Guards pending and stopping, which say whether there is anything for idle workers to do
+		std::mutex idleLock{};
+		std::condition_variable wake{};
+		std::size_t pending{0};
+		bool stopping{false};
+
+		void worker(std::size_t self) noexcept;
+		bool take(std::size_t self, std::function<void ()> &task) noexcept;
+		void stop() noexcept;
+
+	public:
+		CRUNCH_VIS workerPool_t(std::size_t count);
+		workerPool_t(const workerPool_t &) = delete;
+		workerPool_t(workerPool_t &&) = delete;
+		CRUNCH_VIS ~workerPool_t() noexcept;
+		workerPool_t &operator =(const workerPool_t &) = delete;
+		workerPool_t &operator =(workerPool_t &&) = delete;
+
+		// Tasks must not throw - they run outside of any test's exception handling
+		CRUNCH_VIS void submit(std::function<void ()> &&task);
+		std::size_t size() const noexcept { return workers.size(); }
+	};
+
+	// The pool the runner sets up for the duration of a run, or nullptr if there isn't one
+	CRUNCHpp_API workerPool_t *testWorkers;
+} // namespace crunch
+
+#endif /*WORKER_POOL__HXX*/
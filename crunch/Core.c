@@ -1,9 +1,17 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include <stdint.h>
 #include <inttypes.h>
+#include <setjmp.h>
 #include <string.h>
 #include <fenv.h>
 #include <float.h>
+#include <math.h>
+#include <stdio.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 #include "crunch.h"
 #include "Core.h"
 #include "Logger.h"
@@ -13,8 +21,38 @@ test *tests;
 uint32_t passes = 0, failures = 0;
 int32_t allocCount = -1;
 
+static THREAD_LOCAL jmp_buf *testExitTarget = NULL;
+static THREAD_LOCAL int testExitResult = THREAD_SUCCESS;
+
+void testExit(const int result)
+{
+	if (testExitTarget)
+	{
+		testExitResult = result;
+		longjmp(*testExitTarget, 1);
+	}
+	thrd_exit(result);
+}
+
+int catchTestExit(thrd_start_t func, void *arg)
+{
+	jmp_buf exitTarget;
+	jmp_buf *const outerTarget = testExitTarget;
+	int result = THREAD_SUCCESS;
+	testExitTarget = &exitTarget;
+	if (setjmp(exitTarget) == 0)
+		result = func(arg);
+	else
+		result = testExitResult;
+	testExitTarget = outerTarget;
+	return result;
+}
+
+/* What the failures of assertions start with, which is left off them when they are the failure of an expectation */
+#define ASSERTION_PREFIX "Assertion failure: "
+
 #define ASSERTION_FAILURE(what, ...) \
-	logResult(RESULT_FAILURE, "Assertion failure: " what, __VA_ARGS__);
+	logResult(RESULT_FAILURE, ASSERTION_PREFIX what, __VA_ARGS__);
 
 #define ASSERTION_ERROR(params, result, expected) \
 	ASSERTION_FAILURE("expected " params ", got " params, expected, result);
@@ -22,10 +60,88 @@ int32_t allocCount = -1;
 #define ASSERTION_ERROR_NEGATIVE(params, result) \
 	ASSERTION_FAILURE("did not expect " params, result);
 
+/* How many failed expectations are kept for each test. Once a test has this many, the rest are only counted */
+#define MAX_RECORDED_EXPECTATIONS 100U
+/* The expectation being checked on this thread, if any, and those that have failed in the test being run */
+static THREAD_LOCAL uint8_t expecting = FALSE;
+static THREAD_LOCAL const char *expectationFile = NULL;
+static THREAD_LOCAL uint32_t expectationLine = 0;
+static THREAD_LOCAL char *expectationFailures[MAX_RECORDED_EXPECTATIONS];
+static THREAD_LOCAL size_t recordedExpectations = 0;
+static THREAD_LOCAL size_t unrecordedExpectations = 0;
+
+/* Ends the test after an assertion fails, unless the assertion is being checked as an expectation */
+static void assertionExit(void)
+{
+	if (!expecting)
+		testExit(THREAD_ERROR);
+}
+
+void beginExpectation(const char *file, uint32_t line)
+{
+	expecting = TRUE;
+	expectationFile = file;
+	expectationLine = line;
+	/* A test that fails an expectation in a loop stays cheap to run once we've got plenty to report */
+	deferFailures(recordedExpectations < MAX_RECORDED_EXPECTATIONS);
+}
+
+void endExpectation(void)
+{
+	char *failure = NULL;
+	expecting = FALSE;
+	if (!endDeferral(&failure))
+		return;
+	char *record = NULL;
+	if (failure)
+	{
+		const size_t prefixLength = strlen(ASSERTION_PREFIX);
+		const char *const message = strncmp(failure, ASSERTION_PREFIX, prefixLength) == 0 ?
+			failure + prefixLength : failure;
+		record = formatString("%s:%" PRIu32 ": %s", expectationFile, expectationLine, message);
+		free(failure);
+	}
+	if (record)
+		expectationFailures[recordedExpectations++] = record;
+	else
+		++unrecordedExpectations;
+}
+
+uint8_t reportExpectations(const uint8_t alreadyFailed)
+{
+	const size_t count = recordedExpectations + unrecordedExpectations;
+	if (!count)
+		return FALSE;
+	const char *const noun = count == 1 ? "expectation" : "expectations";
+	if (alreadyFailed)
+		testPrintf("%zu %s failed before that:\n", count, noun);
+	else
+		logResult(RESULT_FAILURE, "%zu %s failed", count, noun);
+	for (size_t i = 0; i < recordedExpectations; ++i)
+	{
+		/* Anything printed along with the failure, such as a hexdump, ends up indented under it */
+		const char *line = expectationFailures[i];
+		while (*line)
+		{
+			const char *const end = strchr(line, '\n');
+			const size_t length = end ? (size_t)(end - line) : strlen(line);
+			if (length)
+				testPrintf("\t%.*s\n", (int)length, line);
+			line += length + (end ? 1U : 0U);
+		}
+		free(expectationFailures[i]);
+	}
+	if (unrecordedExpectations)
+		testPrintf("\t%zu more not recorded\n", unrecordedExpectations);
+	recordedExpectations = 0;
+	unrecordedExpectations = 0;
+	return TRUE;
+}
+
 void fail(const char *reason)
 {
 	logResult(RESULT_FAILURE, "Failure: %s", reason);
-	thrd_exit(THREAD_ERROR);
+	testExit(THREAD_ERROR);
 }
 
 void assertTrue(uint8_t value)
@@ -33,7 +149,7 @@ void assertTrue(uint8_t value)
 	if (value == FALSE)
 	{
 		ASSERTION_ERROR("%s", boolToString(value), "true");
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -42,7 +158,7 @@ void assertFalse(uint8_t value)
 	if (value != FALSE)
 	{
 		ASSERTION_ERROR("%s", boolToString(value), "false");
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -51,7 +167,7 @@ void assertIntEqual(int32_t result, int32_t expected)
 	if (result != expected)
 	{
 		ASSERTION_ERROR("%d", result, expected);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -60,7 +176,7 @@ void assertIntNotEqual(int32_t result, int32_t expected)
 	if (result == expected)
 	{
 		ASSERTION_ERROR_NEGATIVE("%d", result);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -69,7 +185,7 @@ void assertInt64Equal(int64_t result, int64_t expected)
 	if (result != expected)
 	{
 		ASSERTION_ERROR("%" PRId64, result, expected);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -78,7 +194,7 @@ void assertInt64NotEqual(int64_t result, int64_t expected)
 	if (result == expected)
 	{
 		ASSERTION_ERROR_NEGATIVE("%" PRId64, result);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -87,7 +203,7 @@ void assertPtrEqual(void *result, void* expected)
 	if (result != expected)
 	{
 		ASSERTION_ERROR("%p", result, expected);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -96,7 +212,7 @@ void assertPtrNotEqual(void *result, void *expected)
 	if (result == expected)
 	{
 		ASSERTION_ERROR_NEGATIVE("%p", result);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -110,7 +226,7 @@ void assertDoubleEqual(double result, double expected)
 	{
 		ASSERTION_ERROR("%g", result, expected);
 		fesetenv(&env);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 	fesetenv(&env);
 }
@@ -123,7 +239,7 @@ void assertDoubleNotEqual(double result, double expected)
 	{
 		ASSERTION_ERROR_NEGATIVE("%g", result);
 		fesetenv(&env);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 	fesetenv(&env);
 }
@@ -133,7 +249,7 @@ void assertStringEqual(const char *result, const char *expected)
 	if (strcmp(result, expected) != 0)
 	{
 		ASSERTION_ERROR("%s", result, expected);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -142,25 +258,563 @@ void assertStringNotEqual(const char *result, const char *expected)
 	if (strcmp(result, expected) == 0)
 	{
 		ASSERTION_ERROR_NEGATIVE("%s", result);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
+	}
+}
+
+/* How many elements either side of the first difference assertRangeEqual() shows */
+#define RANGE_CONTEXT 3U
+/*
+ * How many bytes each line of a buffer hexdump shows, and how many lines either side of the
+ * line with the first difference in it the failure of assertMemEqual() shows
+ */
+#define HEXDUMP_WIDTH 16U
+#define HEXDUMP_CONTEXT 2U
+
+/* Returns the offset of the first byte that differs between two blocks of memory, or length if none do */
+static size_t firstMismatch(const uint8_t *const result, const uint8_t *const expected, const size_t length)
+{
+	size_t offset = 0;
+	/* Compare 16 bytes at a time until a block with a difference in it turns up */
+#if defined(__SSE2__)
+	for (; offset + 16U <= length; offset += 16U)
+	{
+		const __m128i resultBlock = _mm_loadu_si128((const __m128i *)(result + offset));
+		const __m128i expectedBlock = _mm_loadu_si128((const __m128i *)(expected + offset));
+		const uint32_t equal = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(resultBlock, expectedBlock));
+		if (equal != 0xFFFFU)
+			return offset + (size_t)__builtin_ctz(~equal);
+	}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	for (; offset + 16U <= length; offset += 16U)
+	{
+		if (vminvq_u8(vceqq_u8(vld1q_u8(result + offset), vld1q_u8(expected + offset))) != 0xFFU)
+			break;
+	}
+#endif
+	for (; offset < length; ++offset)
+	{
+		if (result[offset] != expected[offset])
+			return offset;
+	}
+	return length;
+}
+
+/* Writes an element out in hex, as a number if it is the size of one, otherwise as its bytes in memory order */
+static void describeElement(char *const buffer, const size_t bufferLength, const uint8_t *const element,
+	const size_t elementSize)
+{
+	uint64_t value = 0;
+	size_t offset = 0;
+	switch (elementSize)
+	{
+		case 1:
+			value = *element;
+			break;
+		case 2:
+		{
+			uint16_t value16;
+			memcpy(&value16, element, sizeof(value16));
+			value = value16;
+			break;
+		}
+		case 4:
+		{
+			uint32_t value32;
+			memcpy(&value32, element, sizeof(value32));
+			value = value32;
+			break;
+		}
+		case 8:
+			memcpy(&value, element, sizeof(value));
+			break;
+		default:
+			for (size_t i = 0; i < elementSize && offset + 3U <= bufferLength; ++i)
+				offset += (size_t)snprintf(buffer + offset, bufferLength - offset, "%02x", element[i]);
+			return;
+	}
+	snprintf(buffer, bufferLength, "0x%0*" PRIx64, (int)(elementSize * 2U), value);
+}
+
+/* Counts how many bytes differ between two blocks of memory */
+static size_t countMismatches(const uint8_t *const result, const uint8_t *const expected, const size_t length)
+{
+	size_t offset = 0;
+	size_t mismatches = 0;
+#if defined(__SSE2__)
+	for (; offset + 16U <= length; offset += 16U)
+	{
+		const __m128i resultBlock = _mm_loadu_si128((const __m128i *)(result + offset));
+		const __m128i expectedBlock = _mm_loadu_si128((const __m128i *)(expected + offset));
+		const uint32_t equal = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(resultBlock, expectedBlock));
+		mismatches += (size_t)__builtin_popcount(~equal & 0xFFFFU);
+	}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	for (; offset + 16U <= length; offset += 16U)
+	{
+		/* Each byte that differs comes out of the compare as 0, so add up the 1s left by those that match */
+		const uint8x16_t equal = vshrq_n_u8(vceqq_u8(vld1q_u8(result + offset), vld1q_u8(expected + offset)), 7);
+		mismatches += 16U - vaddvq_u8(equal);
+	}
+#endif
+	for (; offset < length; ++offset)
+		mismatches += result[offset] != expected[offset] ? 1U : 0U;
+	return mismatches;
+}
+
+/* Prints one line of a hexdump of a buffer, leaving blanks for the bytes past its end */
+static void printHexdumpLine(const uint8_t *const buffer, const size_t offset, const size_t length)
+{
+	for (size_t byte = offset; byte < offset + HEXDUMP_WIDTH; ++byte)
+	{
+		if (byte < length)
+			testPrintf("%02x ", buffer[byte]);
+		else
+			testPrintf("   ");
 	}
 }
 
 void assertMemEqual(const void *result, const void *expected, const size_t expectedLength)
 {
+	/* memcmp() is as fast as it gets for buffers that match, so the difference is only looked for once there is one */
 	if (memcmp(result, expected, expectedLength) != 0)
 	{
-		ASSERTION_FAILURE("buffers %p and %p do not match", result, expected);
-		thrd_exit(THREAD_ERROR);
+		const uint8_t *const resultBytes = (const uint8_t *)result;
+		const uint8_t *const expectedBytes = (const uint8_t *)expected;
+		const size_t offset = firstMismatch(resultBytes, expectedBytes, expectedLength);
+		const size_t firstLine = offset / HEXDUMP_WIDTH;
+		const size_t begin = (firstLine > HEXDUMP_CONTEXT ? firstLine - HEXDUMP_CONTEXT : 0) * HEXDUMP_WIDTH;
+		const size_t lastLine = (firstLine + HEXDUMP_CONTEXT + 1U) * HEXDUMP_WIDTH;
+		const size_t end = lastLine < expectedLength ? lastLine : expectedLength;
+		ASSERTION_FAILURE("buffers %p and %p first differ at offset %zu, %zu of %zu bytes differ", result, expected,
+			offset, countMismatches(resultBytes, expectedBytes, expectedLength), expectedLength);
+		/* Dump the region around the first difference side by side, marking the lines that differ */
+		testPrintf("\t  offset    %-*s %s\n", (int)(HEXDUMP_WIDTH * 3U), "expected", "result");
+		for (size_t line = begin; line < end; line += HEXDUMP_WIDTH)
+		{
+			const size_t lineLength = expectedLength - line < HEXDUMP_WIDTH ? expectedLength - line : HEXDUMP_WIDTH;
+			const uint8_t differs = memcmp(resultBytes + line, expectedBytes + line, lineLength) != 0;
+			testPrintf("\t%c %08zx  ", differs ? '>' : ' ', line);
+			printHexdumpLine(expectedBytes, line, expectedLength);
+			testPrintf(" ");
+			printHexdumpLine(resultBytes, line, expectedLength);
+			testPrintf("\n");
+		}
+		assertionExit();
+	}
+}
+
+void assertRangeEqual(const void *result, const void *expected, size_t count, size_t elementSize)
+{
+	const uint8_t *const resultBytes = (const uint8_t *)result;
+	const uint8_t *const expectedBytes = (const uint8_t *)expected;
+	const size_t offset = firstMismatch(resultBytes, expectedBytes, count * elementSize);
+	if (offset != count * elementSize)
+	{
+		const size_t index = offset / elementSize;
+		const size_t begin = index > RANGE_CONTEXT ? index - RANGE_CONTEXT : 0;
+		const size_t end = index + RANGE_CONTEXT + 1U < count ? index + RANGE_CONTEXT + 1U : count;
+		char resultValue[68];
+		char expectedValue[68];
+		describeElement(resultValue, sizeof(resultValue), resultBytes + index * elementSize, elementSize);
+		describeElement(expectedValue, sizeof(expectedValue), expectedBytes + index * elementSize, elementSize);
+		ASSERTION_FAILURE("ranges first differ at index %zu, expected %s, got %s", index, expectedValue, resultValue);
+		/* Show the elements either side of the difference too, marking those that differ */
+		for (size_t element = begin; element < end; ++element)
+		{
+			describeElement(resultValue, sizeof(resultValue), resultBytes + element * elementSize, elementSize);
+			describeElement(expectedValue, sizeof(expectedValue), expectedBytes + element * elementSize, elementSize);
+			if (memcmp(resultBytes + element * elementSize, expectedBytes + element * elementSize, elementSize) == 0)
+				testPrintf("\t  [%zu] %s\n", element, expectedValue);
+			else
+				testPrintf("\t> [%zu] expected %s, got %s\n", element, expectedValue, resultValue);
+		}
+		assertionExit();
 	}
 }
 
+/*
+ * Counts how many representable values apart two values are. Values of the same sign are as far
+ * apart as the difference of their magnitudes, and those of opposite sign the sum of them.
+ */
+static uint64_t floatUlpDistance(const float result, const float expected)
+{
+	uint32_t resultBits;
+	uint32_t expectedBits;
+	memcpy(&resultBits, &result, sizeof(resultBits));
+	memcpy(&expectedBits, &expected, sizeof(expectedBits));
+	const uint64_t resultMagnitude = resultBits & 0x7FFFFFFFU;
+	const uint64_t expectedMagnitude = expectedBits & 0x7FFFFFFFU;
+	if ((resultBits ^ expectedBits) & 0x80000000U)
+		return resultMagnitude + expectedMagnitude;
+	return resultMagnitude > expectedMagnitude ? resultMagnitude - expectedMagnitude : expectedMagnitude - resultMagnitude;
+}
+
+static uint64_t doubleUlpDistance(const double result, const double expected)
+{
+	uint64_t resultBits;
+	uint64_t expectedBits;
+	memcpy(&resultBits, &result, sizeof(resultBits));
+	memcpy(&expectedBits, &expected, sizeof(expectedBits));
+	const uint64_t resultMagnitude = resultBits & UINT64_C(0x7FFFFFFFFFFFFFFF);
+	const uint64_t expectedMagnitude = expectedBits & UINT64_C(0x7FFFFFFFFFFFFFFF);
+	if ((resultBits ^ expectedBits) & UINT64_C(0x8000000000000000))
+		return resultMagnitude + expectedMagnitude;
+	return resultMagnitude > expectedMagnitude ? resultMagnitude - expectedMagnitude : expectedMagnitude - resultMagnitude;
+}
+
+static uint8_t floatWithinUlps(const float result, const float expected, const uint64_t maxUlps)
+	{ return !isnan(result) && !isnan(expected) && floatUlpDistance(result, expected) <= maxUlps; }
+
+static uint8_t doubleWithinUlps(const double result, const double expected, const uint64_t maxUlps)
+	{ return !isnan(result) && !isnan(expected) && doubleUlpDistance(result, expected) <= maxUlps; }
+
+/*
+ * Values are within tolerance if they are equal, or differ by no more than the larger of the absolute
+ * tolerance and the relative tolerance scaled by the expected value. Infinities must be matched exactly.
+ */
+static float floatAllowedError(const float expected, const float relative, const float absolute)
+{
+	const float scaled = relative * fabsf(expected);
+	return scaled > absolute ? scaled : absolute;
+}
+
+static double doubleAllowedError(const double expected, const double relative, const double absolute)
+{
+	const double scaled = relative * fabs(expected);
+	return scaled > absolute ? scaled : absolute;
+}
+
+static uint8_t floatWithinTolerance(const float result, const float expected, const float relative,
+	const float absolute)
+{
+	const float error = fabsf(result - expected);
+	return result == expected || (error <= floatAllowedError(expected, relative, absolute) && error < INFINITY);
+}
+
+static uint8_t doubleWithinTolerance(const double result, const double expected, const double relative,
+	const double absolute)
+{
+	const double error = fabs(result - expected);
+	return result == expected || (error <= doubleAllowedError(expected, relative, absolute) && error < (double)INFINITY);
+}
+
+static size_t countFloatUlpFailures(const float *const result, const float *const expected, const size_t count,
+	const uint64_t maxUlps)
+{
+	size_t failures = 0;
+	size_t index = 0;
+#if defined(__SSE2__)
+	/*
+	 * Distances between floats fit in 32 bits, which SSE2 can only compare as signed,
+	 * so they are moved down by 2^31 to compare them as unsigned
+	 */
+	const __m128i bias = _mm_set1_epi32(INT32_MIN);
+	const __m128i limit = _mm_xor_si128(_mm_set1_epi32((int32_t)(uint32_t)(maxUlps < UINT32_MAX ? maxUlps : UINT32_MAX)),
+		bias);
+	const __m128i magnitudeMask = _mm_set1_epi32(INT32_MAX);
+	for (; index + 4U <= count; index += 4U)
+	{
+		const __m128 resultValues = _mm_loadu_ps(result + index);
+		const __m128 expectedValues = _mm_loadu_ps(expected + index);
+		const __m128i resultBits = _mm_castps_si128(resultValues);
+		const __m128i expectedBits = _mm_castps_si128(expectedValues);
+		const __m128i resultMagnitude = _mm_and_si128(resultBits, magnitudeMask);
+		const __m128i expectedMagnitude = _mm_and_si128(expectedBits, magnitudeMask);
+		const __m128i oppositeSigns = _mm_srai_epi32(_mm_xor_si128(resultBits, expectedBits), 31);
+		const __m128i difference = _mm_sub_epi32(resultMagnitude, expectedMagnitude);
+		const __m128i differenceSign = _mm_srai_epi32(difference, 31);
+		const __m128i absoluteDifference = _mm_sub_epi32(_mm_xor_si128(difference, differenceSign), differenceSign);
+		const __m128i sum = _mm_add_epi32(resultMagnitude, expectedMagnitude);
+		const __m128i distance = _mm_or_si128(_mm_and_si128(oppositeSigns, sum),
+			_mm_andnot_si128(oppositeSigns, absoluteDifference));
+		const __m128i tooFar = _mm_cmpgt_epi32(_mm_xor_si128(distance, bias), limit);
+		const __m128i notANumber = _mm_castps_si128(_mm_cmpunord_ps(resultValues, expectedValues));
+		failures += (size_t)__builtin_popcount((uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(tooFar, notANumber))));
+	}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	/* NEON compares unsigned, so the distances need no bias, and NaNs are found as they don't equal themselves */
+	const uint32x4_t limit = vdupq_n_u32((uint32_t)(maxUlps < UINT32_MAX ? maxUlps : UINT32_MAX));
+	const uint32x4_t magnitudeMask = vdupq_n_u32((uint32_t)INT32_MAX);
+	for (; index + 4U <= count; index += 4U)
+	{
+		const float32x4_t resultValues = vld1q_f32(result + index);
+		const float32x4_t expectedValues = vld1q_f32(expected + index);
+		const uint32x4_t resultBits = vreinterpretq_u32_f32(resultValues);
+		const uint32x4_t expectedBits = vreinterpretq_u32_f32(expectedValues);
+		const uint32x4_t resultMagnitude = vandq_u32(resultBits, magnitudeMask);
+		const uint32x4_t expectedMagnitude = vandq_u32(expectedBits, magnitudeMask);
+		const uint32x4_t oppositeSigns =
+			vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(veorq_u32(resultBits, expectedBits)), 31));
+		const uint32x4_t distance = vbslq_u32(oppositeSigns, vaddq_u32(resultMagnitude, expectedMagnitude),
+			vabdq_u32(resultMagnitude, expectedMagnitude));
+		const uint32x4_t numbers =
+			vandq_u32(vceqq_f32(resultValues, resultValues), vceqq_f32(expectedValues, expectedValues));
+		const uint32x4_t within = vandq_u32(vcleq_u32(distance, limit), numbers);
+		failures += 4U - (size_t)vaddvq_u32(vshrq_n_u32(within, 31));
+	}
+#endif
+	for (; index < count; ++index)
+		failures += floatWithinUlps(result[index], expected[index], maxUlps) ? 0U : 1U;
+	return failures;
+}
+
+static size_t countDoubleUlpFailures(const double *const result, const double *const expected, const size_t count,
+	const uint64_t maxUlps)
+{
+	/* SSE2 has no 64-bit compares, so this is left to the compiler to vectorise as it can */
+	size_t failures = 0;
+	for (size_t index = 0; index < count; ++index)
+		failures += doubleWithinUlps(result[index], expected[index], maxUlps) ? 0U : 1U;
+	return failures;
+}
+
+static size_t countFloatToleranceFailures(const float *const result, const float *const expected, const size_t count,
+	const float relative, const float absolute)
+{
+	size_t failures = 0;
+	size_t index = 0;
+#if defined(__SSE2__)
+	const __m128 relativeValue = _mm_set1_ps(relative);
+	const __m128 absoluteValue = _mm_set1_ps(absolute);
+	const __m128 magnitudeMask = _mm_castsi128_ps(_mm_set1_epi32(INT32_MAX));
+	const __m128 infinity = _mm_set1_ps(INFINITY);
+	for (; index + 4U <= count; index += 4U)
+	{
+		const __m128 resultValues = _mm_loadu_ps(result + index);
+		const __m128 expectedValues = _mm_loadu_ps(expected + index);
+		const __m128 error = _mm_and_ps(_mm_sub_ps(resultValues, expectedValues), magnitudeMask);
+		const __m128 allowed = _mm_max_ps(absoluteValue, _mm_mul_ps(relativeValue, _mm_and_ps(expectedValues, magnitudeMask)));
+		const __m128 within = _mm_or_ps(_mm_cmpeq_ps(resultValues, expectedValues),
+			_mm_and_ps(_mm_cmple_ps(error, allowed), _mm_cmplt_ps(error, infinity)));
+		failures += 4U - (size_t)__builtin_popcount((uint32_t)_mm_movemask_ps(within));
+	}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	const float32x4_t relativeValue = vdupq_n_f32(relative);
+	const float32x4_t absoluteValue = vdupq_n_f32(absolute);
+	const float32x4_t infinity = vdupq_n_f32(INFINITY);
+	for (; index + 4U <= count; index += 4U)
+	{
+		const float32x4_t resultValues = vld1q_f32(result + index);
+		const float32x4_t expectedValues = vld1q_f32(expected + index);
+		const float32x4_t error = vabdq_f32(resultValues, expectedValues);
+		const float32x4_t allowed = vmaxq_f32(absoluteValue, vmulq_f32(relativeValue, vabsq_f32(expectedValues)));
+		const uint32x4_t within = vorrq_u32(vceqq_f32(resultValues, expectedValues),
+			vandq_u32(vcleq_f32(error, allowed), vcltq_f32(error, infinity)));
+		failures += 4U - vaddvq_u32(vshrq_n_u32(within, 31));
+	}
+#endif
+	for (; index < count; ++index)
+		failures += floatWithinTolerance(result[index], expected[index], relative, absolute) ? 0U : 1U;
+	return failures;
+}
+
+static size_t countDoubleToleranceFailures(const double *const result, const double *const expected,
+	const size_t count, const double relative, const double absolute)
+{
+	size_t failures = 0;
+	size_t index = 0;
+#if defined(__SSE2__)
+	const __m128d relativeValue = _mm_set1_pd(relative);
+	const __m128d absoluteValue = _mm_set1_pd(absolute);
+	const __m128d magnitudeMask = _mm_castsi128_pd(_mm_set1_epi64x(INT64_MAX));
+	const __m128d infinity = _mm_set1_pd((double)INFINITY);
+	for (; index + 2U <= count; index += 2U)
+	{
+		const __m128d resultValues = _mm_loadu_pd(result + index);
+		const __m128d expectedValues = _mm_loadu_pd(expected + index);
+		const __m128d error = _mm_and_pd(_mm_sub_pd(resultValues, expectedValues), magnitudeMask);
+		const __m128d allowed = _mm_max_pd(absoluteValue, _mm_mul_pd(relativeValue, _mm_and_pd(expectedValues, magnitudeMask)));
+		const __m128d within = _mm_or_pd(_mm_cmpeq_pd(resultValues, expectedValues),
+			_mm_and_pd(_mm_cmple_pd(error, allowed), _mm_cmplt_pd(error, infinity)));
+		failures += 2U - (size_t)__builtin_popcount((uint32_t)_mm_movemask_pd(within));
+	}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	const float64x2_t relativeValue = vdupq_n_f64(relative);
+	const float64x2_t absoluteValue = vdupq_n_f64(absolute);
+	const float64x2_t infinity = vdupq_n_f64((double)INFINITY);
+	for (; index + 2U <= count; index += 2U)
+	{
+		const float64x2_t resultValues = vld1q_f64(result + index);
+		const float64x2_t expectedValues = vld1q_f64(expected + index);
+		const float64x2_t error = vabdq_f64(resultValues, expectedValues);
+		const float64x2_t allowed = vmaxq_f64(absoluteValue, vmulq_f64(relativeValue, vabsq_f64(expectedValues)));
+		const uint64x2_t within = vorrq_u64(vceqq_f64(resultValues, expectedValues),
+			vandq_u64(vcleq_f64(error, allowed), vcltq_f64(error, infinity)));
+		failures += 2U - (size_t)vaddvq_u64(vshrq_n_u64(within, 63));
+	}
+#endif
+	for (; index < count; ++index)
+		failures += doubleWithinTolerance(result[index], expected[index], relative, absolute) ? 0U : 1U;
+	return failures;
+}
+
+/* How the errors of the elements out of tolerance are spread, as multiples of the tolerance */
+typedef struct errorSpread
+{
+	size_t failures;
+	size_t worst;
+	double worstRatio;
+	size_t buckets[5];
+} errorSpread;
+
+static const char *const bucketNames[5] =
+{
+	"up to 2x the tolerance", "2x to 4x the tolerance", "4x to 16x the tolerance",
+	"16x to 256x the tolerance", "over 256x the tolerance, or not a number"
+};
+
+static void noteError(errorSpread *const spread, const size_t index, double ratio)
+{
+	if (isnan(ratio))
+		ratio = (double)INFINITY;
+	++spread->failures;
+	if (spread->failures == 1 || ratio > spread->worstRatio)
+	{
+		spread->worst = index;
+		spread->worstRatio = ratio;
+	}
+	spread->buckets[ratio <= 2.0 ? 0 : ratio <= 4.0 ? 1 : ratio <= 16.0 ? 2 : ratio <= 256.0 ? 3 : 4]++;
+}
+
+static void printSpread(const errorSpread *const spread)
+{
+	for (size_t bucket = 0; bucket < 5; ++bucket)
+	{
+		if (spread->buckets[bucket])
+			testPrintf("\t%zu %s %s\n", spread->buckets[bucket], spread->buckets[bucket] == 1 ? "element" : "elements",
+				bucketNames[bucket]);
+	}
+}
+
+static double ulpRatio(const uint8_t notANumber, const uint64_t distance, const uint64_t maxUlps)
+	{ return notANumber || !maxUlps ? (double)INFINITY : (double)distance / (double)maxUlps; }
+
+static void ulpFailure(const errorSpread *const spread, const size_t count, const int digits, const double result,
+	const double expected, const uint64_t distance, const uint64_t maxUlps)
+{
+	if (count == 1)
+		ASSERTION_FAILURE("expected %.*g, got %.*g, %" PRIu64 " ULPs apart with %" PRIu64 " allowed", digits, expected,
+			digits, result, distance, maxUlps)
+	else
+	{
+		ASSERTION_FAILURE("%zu of %zu elements out of tolerance, worst at index %zu: expected %.*g, got %.*g, %" PRIu64
+			" ULPs apart with %" PRIu64 " allowed", spread->failures, count, spread->worst, digits, expected, digits,
+			result, distance, maxUlps)
+		printSpread(spread);
+	}
+	assertionExit();
+}
+
+static void toleranceFailure(const errorSpread *const spread, const size_t count, const int digits,
+	const double result, const double expected, const double error, const double allowed)
+{
+	if (count == 1)
+		ASSERTION_FAILURE("expected %.*g, got %.*g, off by %g with %g allowed", digits, expected, digits, result,
+			error, allowed)
+	else
+	{
+		ASSERTION_FAILURE("%zu of %zu elements out of tolerance, worst at index %zu: expected %.*g, got %.*g, "
+			"off by %g with %g allowed", spread->failures, count, spread->worst, digits, expected, digits, result,
+			error, allowed)
+		printSpread(spread);
+	}
+	assertionExit();
+}
+
+/* How many significant digits it takes to tell apart every float, and every double */
+#define FLOAT_DIGITS 9
+#define DOUBLE_DIGITS 17
+
+void assertFloatArrayUlpEqual(const float *result, const float *expected, size_t count, uint64_t maxUlps)
+{
+	if (countFloatUlpFailures(result, expected, count, maxUlps))
+	{
+		errorSpread spread = {0};
+		for (size_t index = 0; index < count; ++index)
+		{
+			if (!floatWithinUlps(result[index], expected[index], maxUlps))
+				noteError(&spread, index, ulpRatio(isnan(result[index]) || isnan(expected[index]),
+					floatUlpDistance(result[index], expected[index]), maxUlps));
+		}
+		const size_t worst = spread.worst;
+		ulpFailure(&spread, count, FLOAT_DIGITS, result[worst], expected[worst],
+			floatUlpDistance(result[worst], expected[worst]), maxUlps);
+	}
+}
+
+void assertDoubleArrayUlpEqual(const double *result, const double *expected, size_t count, uint64_t maxUlps)
+{
+	if (countDoubleUlpFailures(result, expected, count, maxUlps))
+	{
+		errorSpread spread = {0};
+		for (size_t index = 0; index < count; ++index)
+		{
+			if (!doubleWithinUlps(result[index], expected[index], maxUlps))
+				noteError(&spread, index, ulpRatio(isnan(result[index]) || isnan(expected[index]),
+					doubleUlpDistance(result[index], expected[index]), maxUlps));
+		}
+		const size_t worst = spread.worst;
+		ulpFailure(&spread, count, DOUBLE_DIGITS, result[worst], expected[worst],
+			doubleUlpDistance(result[worst], expected[worst]), maxUlps);
+	}
+}
+
+void assertFloatArrayNear(const float *result, const float *expected, size_t count, double relative, double absolute)
+{
+	const float relativeFloat = (float)relative;
+	const float absoluteFloat = (float)absolute;
+	if (countFloatToleranceFailures(result, expected, count, relativeFloat, absoluteFloat))
+	{
+		errorSpread spread = {0};
+		for (size_t index = 0; index < count; ++index)
+		{
+			if (!floatWithinTolerance(result[index], expected[index], relativeFloat, absoluteFloat))
+				noteError(&spread, index, (double)fabsf(result[index] - expected[index]) /
+					(double)floatAllowedError(expected[index], relativeFloat, absoluteFloat));
+		}
+		const size_t worst = spread.worst;
+		toleranceFailure(&spread, count, FLOAT_DIGITS, result[worst], expected[worst],
+			fabsf(result[worst] - expected[worst]), floatAllowedError(expected[worst], relativeFloat, absoluteFloat));
+	}
+}
+
+void assertDoubleArrayNear(const double *result, const double *expected, size_t count, double relative,
+	double absolute)
+{
+	if (countDoubleToleranceFailures(result, expected, count, relative, absolute))
+	{
+		errorSpread spread = {0};
+		for (size_t index = 0; index < count; ++index)
+		{
+			if (!doubleWithinTolerance(result[index], expected[index], relative, absolute))
+				noteError(&spread, index, fabs(result[index] - expected[index]) /
+					doubleAllowedError(expected[index], relative, absolute));
+		}
+		const size_t worst = spread.worst;
+		toleranceFailure(&spread, count, DOUBLE_DIGITS, result[worst], expected[worst],
+			fabs(result[worst] - expected[worst]), doubleAllowedError(expected[worst], relative, absolute));
+	}
+}
+
+void assertFloatUlpEqual(float result, float expected, uint64_t maxUlps)
+	{ assertFloatArrayUlpEqual(&result, &expected, 1, maxUlps); }
+
+void assertDoubleUlpEqual(double result, double expected, uint64_t maxUlps)
+	{ assertDoubleArrayUlpEqual(&result, &expected, 1, maxUlps); }
+
+void assertFloatNear(float result, float expected, double relative, double absolute)
+	{ assertFloatArrayNear(&result, &expected, 1, relative, absolute); }
+
+void assertDoubleNear(double result, double expected, double relative, double absolute)
+	{ assertDoubleArrayNear(&result, &expected, 1, relative, absolute); }
+
 void assertMemNotEqual(const void *result, const void *expected, const size_t expectedLength)
 {
 	if (memcmp(result, expected, expectedLength) == 0)
 	{
 		ASSERTION_FAILURE("buffers %p and %p match", result, expected);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -169,7 +823,7 @@ void assertNull(const void *const result)
 	if (result != NULL)
 	{
 		ASSERTION_ERROR("%p", result, NULL);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -178,7 +832,7 @@ void assertNotNull(const void *const result)
 	if (result == NULL)
 	{
 		ASSERTION_ERROR_NEGATIVE("%p", result);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -187,7 +841,7 @@ void assertGreaterThan(int32_t result, int32_t expected)
 	if (result <= expected)
 	{
 		ASSERTION_FAILURE("%d was not greater than %d", result, expected);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -196,7 +850,7 @@ void assertGreaterThan64(int64_t result, int64_t expected)
 	if (result <= expected)
 	{
 		ASSERTION_FAILURE("%" PRId64 " was not greater than %" PRId64, result, expected);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -205,7 +859,7 @@ void assertLessThan(int32_t result, int32_t expected)
 	if (result >= expected)
 	{
 		ASSERTION_FAILURE("%d was not less than %d", result, expected);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
 
@@ -214,6 +868,6 @@ void assertLessThan64(int64_t result, int64_t expected)
 	if (result >= expected)
 	{
 		ASSERTION_FAILURE("%" PRId64 " was not less than %" PRId64, result, expected);
-		thrd_exit(THREAD_ERROR);
+		assertionExit();
 	}
 }
@@ -16,4 +16,13 @@ enum
 	THREAD_ABORT = 2
 };
 
+// Ends the current test with the given THREAD_* result. Within catchTestExit() this unwinds
+// back to it, otherwise the calling thread exits with the result.
+NORETURN(void testExit(int result));
+// Runs func(arg) on the calling thread, returning its result or the result given to testExit()
+CRUNCH_API int catchTestExit(thrd_start_t func, void *arg);
+// Reports the expectations that failed on the calling thread during the test just run, returning whether
+// there were any. They are logged as a failure of the test unless alreadyFailed says it already has been.
+CRUNCH_API uint8_t reportExpectations(uint8_t alreadyFailed);
+
 #endif /*CORE__H*/
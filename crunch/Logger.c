@@ -12,11 +12,15 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/file.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 #else
 #include <io.h>
 #include <sys/locking.h>
 #endif
 #include <stdio.h>
+#include <string.h>
 
 #ifndef _WIN32
 #define COL(val) ((val) - 8)
@@ -41,6 +45,21 @@ struct testLog
 
 testLog *logger = NULL;
 uint8_t isTTY = 1;
+uint8_t captureTestOutput = 0;
+// Where our own output goes while test output is being captured
+static FILE *consoleStream = NULL;
+// The buffer output is going to, and the descriptors stdout and stderr had before, while capturing
+static int captureFD = -1;
+static int savedStdout = -1;
+static int savedStderr = -1;
+// While deferring, failures logged from this thread and anything printed after them are gathered up
+// here (or only noted, if they aren't being kept) rather than printed, so they can be reported later
+static THREAD_LOCAL uint8_t deferring = FALSE;
+static THREAD_LOCAL uint8_t keepingDeferred = FALSE;
+static THREAD_LOCAL uint8_t deferredFailure = FALSE;
+static THREAD_LOCAL char *deferredOutput = NULL;
+static THREAD_LOCAL size_t deferredLength = 0;
+static THREAD_LOCAL size_t deferredCapacity = 0;
 
 #ifndef _WIN32
 int getColumns(void)
@@ -58,8 +77,54 @@ uint16_t getColumns(void)
 }
 #endif
 
+static size_t vaDeferPrintf(const char *format, va_list args)
+{
+	if (!keepingDeferred)
+		return 0;
+	va_list lengthArgs;
+	va_copy(lengthArgs, args);
+	const int length = vsnprintf(NULL, 0, format, lengthArgs);
+	va_end(lengthArgs);
+	if (length <= 0)
+		return 0;
+	const size_t required = deferredLength + (size_t)length + 1U;
+	if (required > deferredCapacity)
+	{
+		const size_t capacity = required > deferredCapacity * 2U ? required : deferredCapacity * 2U;
+		char *const output = realloc(deferredOutput, capacity);
+		if (!output)
+			return 0;
+		deferredOutput = output;
+		deferredCapacity = capacity;
+	}
+	vsnprintf(deferredOutput + deferredLength, (size_t)length + 1U, format, args);
+	deferredLength += (size_t)length;
+	return (size_t)length;
+}
+
+void deferFailures(const uint8_t keep)
+{
+	deferring = TRUE;
+	keepingDeferred = keep;
+	deferredFailure = FALSE;
+}
+
+uint8_t endDeferral(char **const failure)
+{
+	deferring = FALSE;
+	*failure = deferredOutput;
+	deferredOutput = NULL;
+	deferredLength = 0;
+	deferredCapacity = 0;
+	return deferredFailure;
+}
+
 size_t vaTestPrintf(const char *format, va_list args)
-	{ return vfprintf(logger ? logger->stdout_ : stdout, format, args); }
+{
+	if (deferring)
+		return vaDeferPrintf(format, args);
+	return vfprintf(logger ? logger->stdout_ : consoleStream ? consoleStream : stdout, format, args);
+}
 
 size_t testPrintf(const char *format, ...)
 {
@@ -70,9 +135,9 @@ size_t testPrintf(const char *format, ...)
 	return ret;
 }
 
-void printOk(void)
+void printOk(const char *timing)
 {
-	testPrintf("[  OK  ]\n");
+	testPrintf("%s%s[  OK  ]\n", timing, *timing ? " " : "");
 }
 
 void printFailure(void)
@@ -85,13 +150,22 @@ void printAborted(void)
 	testPrintf("[ **** ABORTED **** ]\n");
 }
 
+// Works out the column to start the OK marker at, along with the test's timing if we have it
+int okColumn(const char *timing)
+{
+	const size_t length = *timing ? strlen(timing) + 1 : 0;
+	const int column = (int)COL(getColumns()) - (int)length;
+	return column < 1 ? 1 : column;
+}
+
 #ifndef _WIN32
-void echoOk(void)
+void echoOk(const char *timing)
 {
 	if (isTTY != 0)
-		testPrintf(CURS_UP SET_COL BRACKET "[" SUCCESS "  OK  " BRACKET "]" NEWLINE, COL(getColumns()));
+		testPrintf(CURS_UP SET_COL "%s%s" BRACKET "[" SUCCESS "  OK  " BRACKET "]" NEWLINE, okColumn(timing),
+			timing, *timing ? " " : "");
 	else
-		printOk();
+		printOk(timing);
 	passes++;
 }
 
@@ -110,18 +184,19 @@ void echoAborted(void)
 		testPrintf("\n" BRACKET "[" FAILURE " **** ABORTED **** " BRACKET "]" NEWLINE);
 	else
 		printAborted();
-	thrd_exit(THREAD_ABORT);
+	testExit(THREAD_ABORT);
 }
 #else
-void echoOk(void)
+void echoOk(const char *timing)
 {
 	if (isTTY != 0)
 	{
 		CONSOLE_SCREEN_BUFFER_INFO cursor;
 		GetConsoleScreenBufferInfo(console, &cursor);
 		cursor.dwCursorPosition.Y--;
-		cursor.dwCursorPosition.X = COL(getColumns());
+		cursor.dwCursorPosition.X = (SHORT)okColumn(timing);
 		SetConsoleCursorPosition(console, cursor.dwCursorPosition);
+		testPrintf("%s%s", timing, *timing ? " " : "");
 		SetConsoleTextAttribute(console, FOREGROUND_BLUE | FOREGROUND_INTENSITY);
 		testPrintf("[");
 		SetConsoleTextAttribute(console, FOREGROUND_GREEN | FOREGROUND_INTENSITY);
@@ -132,7 +207,7 @@ void echoOk(void)
 		testPrintf("\n");
 	}
 	else
-		printOk();
+		printOk(timing);
 	passes++;
 }
 
@@ -173,7 +248,7 @@ void echoAborted(void)
 	}
 	else
 		printAborted();
-	thrd_exit(THREAD_ABORT);
+	testExit(THREAD_ABORT);
 }
 #endif
 
@@ -181,6 +256,16 @@ void logResult(resultType type, const char *message, ...)
 {
 	va_list args;
 
+	// A deferred failure is only gathered up, so doesn't end up on the console or counted yet
+	if (deferring && type == RESULT_FAILURE)
+	{
+		deferredFailure = TRUE;
+		va_start(args, message);
+		vaDeferPrintf(message, args);
+		va_end(args);
+		testPrintf("\n");
+		return;
+	}
 	if (isTTY != 0)
 #ifndef _WIN32
 		testPrintf(NORMAL);
@@ -193,7 +278,7 @@ void logResult(resultType type, const char *message, ...)
 	switch (type)
 	{
 		case RESULT_SUCCESS:
-			echoOk();
+			echoOk("");
 			break;
 		case RESULT_FAILURE:
 			echoFailure();
@@ -203,6 +288,117 @@ void logResult(resultType type, const char *message, ...)
 	}
 }
 
+void logSuccess(const char *timing)
+{
+	if (isTTY != 0)
+#ifndef _WIN32
+		testPrintf(NORMAL);
+#else
+		SetConsoleTextAttribute(console, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+#endif
+	echoOk(timing);
+}
+
+uint8_t startCapturing(void)
+{
+	if (consoleStream)
+		return TRUE;
+	fflush(stdout);
+	const int fd = dup(fileno(stdout));
+	if (fd == -1)
+		return FALSE;
+	consoleStream = fdopen(fd, "w");
+	if (!consoleStream)
+	{
+		close(fd);
+		return FALSE;
+	}
+	captureTestOutput = TRUE;
+	return TRUE;
+}
+
+// Makes the buffer to capture into, in memory where we can
+int makeCaptureBuffer(void)
+{
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+	const int fd = memfd_create("crunch test output", MFD_CLOEXEC);
+	if (fd != -1)
+		return fd;
+#endif
+	FILE *file = tmpfile();
+	if (!file)
+		return -1;
+	const int tmpFD = dup(fileno(file));
+	fclose(file);
+	return tmpFD;
+}
+
+void restoreOutput(void)
+{
+	dup2(savedStdout, fileno(stdout));
+	dup2(savedStderr, fileno(stderr));
+	close(savedStdout);
+	close(savedStderr);
+	savedStdout = -1;
+	savedStderr = -1;
+}
+
+uint8_t beginCapture(void)
+{
+	if (!captureTestOutput)
+		return FALSE;
+	// Make sure the test's name is out before the test gets to run
+	fflush(consoleStream);
+	fflush(stdout);
+	fflush(stderr);
+	captureFD = makeCaptureBuffer();
+	savedStdout = dup(fileno(stdout));
+	savedStderr = dup(fileno(stderr));
+	if (captureFD == -1 || savedStdout == -1 || savedStderr == -1 ||
+		dup2(captureFD, fileno(stdout)) == -1 || dup2(captureFD, fileno(stderr)) == -1)
+	{
+		if (savedStdout != -1 && savedStderr != -1)
+			restoreOutput();
+		if (captureFD != -1)
+			close(captureFD);
+		if (savedStdout != -1)
+			close(savedStdout);
+		if (savedStderr != -1)
+			close(savedStderr);
+		captureFD = savedStdout = savedStderr = -1;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+void endCapture(const uint8_t replay)
+{
+	if (captureFD == -1)
+		return;
+	fflush(stdout);
+	fflush(stderr);
+	restoreOutput();
+	const long length = lseek(captureFD, 0, SEEK_END);
+	if (replay && length > 0 && lseek(captureFD, 0, SEEK_SET) == 0)
+	{
+		char buffer[4096];
+		char last = '\n';
+		testPrintf("Captured output:\n");
+		while (1)
+		{
+			const long count = (long)read(captureFD, buffer, sizeof(buffer));
+			if (count <= 0)
+				break;
+			fwrite(buffer, 1, (size_t)count, consoleStream);
+			last = buffer[count - 1];
+		}
+		if (last != '\n')
+			testPrintf("\n");
+	}
+	close(captureFD);
+	captureFD = -1;
+}
+
 testLog *startLogging(const char *fileName)
 {
 	if (logger || !fileName)
@@ -21,10 +21,28 @@ CRUNCH_API uint8_t isTTY;
 CRUNCH_API HANDLE console;
 #endif
 CRUNCH_API testLog *logger;
+// Whether what each test writes to stdout and stderr is captured, to be printed only if the test fails
+CRUNCH_API uint8_t captureTestOutput;
 
 CRUNCH_API size_t vaTestPrintf(const char *format, va_list args);
 CRUNCH_API size_t testPrintf(const char *format, ...);
 CRUNCH_API void logResult(resultType type, const char *message, ...);
+// Logs the success of a test, printing how long it took ahead of the OK marker
+CRUNCH_API void logSuccess(const char *timing);
+// Gives the runner its own copy of stdout so its output is never captured along with a test's, and
+// turns on capturing test output. Returns FALSE if that was not possible.
+CRUNCH_API uint8_t startCapturing(void);
+// Redirects stdout and stderr into an in-memory buffer for the test about to be run
+CRUNCH_API uint8_t beginCapture(void);
+// Puts stdout and stderr back, printing what was captured if asked to as the test failed
+CRUNCH_API void endCapture(uint8_t replay);
+// Starts gathering up failures logged from the calling thread, and anything printed after them, rather than
+// printing them, so the failure of an expectation can be reported once its test is over. Unless keep is set,
+// what's printed is thrown away rather than gathered up.
+CRUNCH_API void deferFailures(uint8_t keep);
+// Stops gathering up failures, returning whether any were logged. What was gathered up is handed over
+// in failure for the caller to free, or failure is set to NULL if nothing was.
+CRUNCH_API uint8_t endDeferral(char **failure);
 
 #define COLOUR(Code) "\x1B[" Code "m"
 #define NORMAL COLOUR("0;39")
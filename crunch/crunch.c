@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <string.h>
+#include <time.h>
 #include "Core.h"
 #include "Logger.h"
 #include "ArgsParser.h"
@@ -43,6 +44,7 @@ char *dlerror(void)
 const arg_t crunchArgs[] =
 {
 	{"--log", 1, 1, 0},
+	{"--capture", 0, 0, 0},
 	{"--version", 0, 0, 0},
 	{"-v", 0, 0, 0},
 	{"--help", 0, 0, 0},
@@ -109,6 +111,126 @@ void newline(void)
 		testPrintf("\n");
 }
 
+// How long a test took by the wall clock and in CPU time used by the thread running it, in nanoseconds
+typedef struct testTiming_t
+{
+	uint64_t wallTime;
+	uint64_t cpuTime;
+} testTiming_t;
+
+typedef struct slowTest_t
+{
+	const char *library;
+	const char *testName;
+	testTiming_t timing;
+} slowTest_t;
+
+// How many of the slowest tests printSlowest() reports
+#define SLOWEST_COUNT 5U
+#define TIMING_LENGTH 64U
+
+// The library whose tests are being run, when the current test started, and how long the last to finish took
+const char *currentLibrary = NULL;
+testTiming_t testStart;
+testTiming_t testTiming;
+slowTest_t slowest[SLOWEST_COUNT];
+size_t slowestCount = 0;
+
+testTiming_t timeNow(void)
+{
+	testTiming_t now;
+#ifndef _WIN32
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	now.wallTime = (uint64_t)time.tv_sec * 1000000000U + (uint64_t)time.tv_nsec;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time))
+		now.cpuTime = 0;
+	else
+		now.cpuTime = (uint64_t)time.tv_sec * 1000000000U + (uint64_t)time.tv_nsec;
+#else
+	LARGE_INTEGER counter;
+	LARGE_INTEGER frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	now.wallTime = (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		now.cpuTime = 0;
+	else
+		// FILETIMEs count in units of 100ns
+		now.cpuTime = ((((uint64_t)kernel.dwHighDateTime << 32U) | kernel.dwLowDateTime) +
+			(((uint64_t)user.dwHighDateTime << 32U) | user.dwLowDateTime)) * 100U;
+#endif
+	return now;
+}
+
+testTiming_t timeSince(const testTiming_t *start)
+{
+	testTiming_t elapsed = timeNow();
+	elapsed.wallTime -= start->wallTime;
+	elapsed.cpuTime -= start->cpuTime;
+	return elapsed;
+}
+
+size_t formatDuration(char *buffer, const size_t length, const uint64_t duration)
+{
+	int result;
+	if (duration < 1000U)
+		result = snprintf(buffer, length, "%uns", (unsigned)duration);
+	else if (duration < 1000000U)
+		result = snprintf(buffer, length, "%.2fus", (double)duration / 1e3);
+	else if (duration < 1000000000U)
+		result = snprintf(buffer, length, "%.2fms", (double)duration / 1e6);
+	else
+		result = snprintf(buffer, length, "%.2fs", (double)duration / 1e9);
+	return result < 0 ? 0 : (size_t)result;
+}
+
+void formatTiming(char *buffer, const size_t length, const testTiming_t *timing)
+{
+	size_t offset = formatDuration(buffer, length, timing->wallTime);
+	offset += (size_t)snprintf(buffer + offset, length - offset, " wall, ");
+	offset += formatDuration(buffer + offset, length - offset, timing->cpuTime);
+	snprintf(buffer + offset, length - offset, " CPU");
+}
+
+void recordTiming(const test *theTest, const testTiming_t *timing)
+{
+	// When we're logging, stdout is the log file
+	if (loggingTests && logger)
+	{
+		char text[TIMING_LENGTH];
+		formatTiming(text, TIMING_LENGTH, timing);
+		printf("%s::%s took %s\n", currentLibrary, theTest->testName, text);
+	}
+
+	// slowest is kept sorted longest first, so only a test slower than the last entry can make the list
+	if (slowestCount == SLOWEST_COUNT && timing->wallTime <= slowest[SLOWEST_COUNT - 1U].timing.wallTime)
+		return;
+	size_t position = 0;
+	while (position < slowestCount && timing->wallTime <= slowest[position].timing.wallTime)
+		++position;
+	if (slowestCount < SLOWEST_COUNT)
+		++slowestCount;
+	memmove(slowest + position + 1, slowest + position, sizeof(slowTest_t) * (slowestCount - position - 1U));
+	slowest[position].library = currentLibrary;
+	slowest[position].testName = theTest->testName;
+	slowest[position].timing = *timing;
+}
+
+void printSlowest(void)
+{
+	if (!slowestCount)
+		return;
+	testPrintf("Slowest tests:\n");
+	for (size_t i = 0; i < slowestCount; ++i)
+	{
+		char text[TIMING_LENGTH];
+		formatTiming(text, TIMING_LENGTH, &slowest[i].timing);
+		testPrintf("\t%s::%s: %s\n", slowest[i].library, slowest[i].testName, text);
+	}
+}
+
 int testRunner(void *testPtr)
 {
 	test *theTest = testPtr;
@@ -123,16 +245,119 @@ int testRunner(void *testPtr)
 		newline();
 	else
 		testPrintf(" ");
+	testStart = timeNow();
 	theTest->testFunc();
+	testTiming = timeSince(&testStart);
 	allocCount = -1;
 	// Did the test switch logging on?
 	if (!loggingTests && logger)
 		// Yes, switch it back off again
 		stopLogging(logger);
-	logResult(RESULT_SUCCESS, "");
+	// Expectations that failed let the test run on to its end, so it's only now that it fails
+	if (reportExpectations(FALSE))
+		return THREAD_ERROR;
+	char timing[TIMING_LENGTH];
+	formatTiming(timing, TIMING_LENGTH, &testTiming);
+	logSuccess(timing);
+	return THREAD_SUCCESS;
+}
+
+// The runner thread the tests are handed to. It lives for the whole run, walking each suite's
+// tests in turn, so running a test does not cost a thread create and join.
+typedef struct testWorker_t
+{
+	thrd_t thread;
+	mtx_t lock;
+	cnd_t wake;
+	test *suite;
+	int result;
+	uint8_t stopping;
+} testWorker_t;
+
+int testWorker(void *workerPtr)
+{
+	testWorker_t *worker = workerPtr;
+	mtx_lock(&worker->lock);
+	while (1)
+	{
+		while (!worker->suite && !worker->stopping)
+			cnd_wait(&worker->wake, &worker->lock);
+		if (!worker->suite)
+			break;
+		test *currTest = worker->suite;
+		mtx_unlock(&worker->lock);
+
+		int result = THREAD_SUCCESS;
+		while (currTest->testFunc && result != THREAD_ABORT)
+		{
+			const uint32_t failuresBefore = failures;
+			const uint8_t capturing = beginCapture();
+			result = catchTestExit(testRunner, currTest);
+			allocCount = -1;
+			if (result != THREAD_SUCCESS)
+				reportExpectations(failures != failuresBefore);
+			if (capturing)
+				endCapture(failures != failuresBefore || result == THREAD_ABORT);
+			// A test that failed never got to take its own timing
+			if (result != THREAD_SUCCESS)
+				testTiming = timeSince(&testStart);
+			recordTiming(currTest, &testTiming);
+			++currTest;
+		}
+
+		mtx_lock(&worker->lock);
+		worker->suite = NULL;
+		worker->result = result;
+		cnd_broadcast(&worker->wake);
+	}
+	mtx_unlock(&worker->lock);
 	return THREAD_SUCCESS;
 }
 
+int startWorker(testWorker_t *worker)
+{
+	worker->suite = NULL;
+	worker->result = THREAD_SUCCESS;
+	worker->stopping = FALSE;
+	if (mtx_init(&worker->lock, mtx_plain) != thrd_success)
+		return thrd_error;
+	if (cnd_init(&worker->wake) != thrd_success)
+	{
+		mtx_destroy(&worker->lock);
+		return thrd_error;
+	}
+	const int result = thrd_create(&worker->thread, testWorker, worker);
+	if (result != thrd_success)
+	{
+		cnd_destroy(&worker->wake);
+		mtx_destroy(&worker->lock);
+	}
+	return result;
+}
+
+void stopWorker(testWorker_t *worker)
+{
+	mtx_lock(&worker->lock);
+	worker->stopping = TRUE;
+	cnd_broadcast(&worker->wake);
+	mtx_unlock(&worker->lock);
+	thrd_join(worker->thread, NULL);
+	cnd_destroy(&worker->wake);
+	mtx_destroy(&worker->lock);
+}
+
+int runSuite(testWorker_t *worker, test *suite)
+{
+	mtx_lock(&worker->lock);
+	worker->suite = suite;
+	cnd_broadcast(&worker->wake);
+	while (worker->suite)
+		cnd_wait(&worker->wake, &worker->lock);
+	const int result = worker->result;
+	mtx_unlock(&worker->lock);
+	return result;
+}
+
 void printStats(void)
 {
 	uint64_t total = passes + failures;
@@ -141,6 +366,7 @@ void printStats(void)
 		testPrintf("--\n");
 	else
 		testPrintf("%0.2f%%\n", ((double)passes) / ((double)total) * 100.0);
+	printSlowest();
 }
 
 void red(void)
@@ -249,11 +475,27 @@ int runTests(void)
 		loggingTests = 1;
 	}
 
+	if (findArg(parsedArgs, "--capture", NULL) && !startCapturing())
+		testPrintf("Warning: could not set up capturing test output, tests will write straight to the console\n");
+
+	testWorker_t worker;
+	const int result = startWorker(&worker);
+	// Check if creating the runner thread for the tests worked or not
+	if (result != thrd_success)
+	{
+		// It did not.. great.. display that and abort
+		red();
+		testPrintf("Test runner failed to start, error code %d. Aborting.", result);
+		newline();
+		return THREAD_ABORT;
+	}
+
 	for (uint32_t i = 0; i < numTests; i++)
 	{
 		char *testLib = extForLibrary(namedTests[i]->value);
 		if (!testLib)
 		{
+			stopWorker(&worker);
 			noMemory();
 			return THREAD_ABORT;
 		}
@@ -282,29 +524,15 @@ int runTests(void)
 		magenta();
 		testPrintf("Running test suite %s...", namedTests[i]->value);
 		newline();
-		test *currTest = tests;
-		while (currTest->testFunc)
+		currentLibrary = namedTests[i]->value;
+		if (runSuite(&worker, tests) == THREAD_ABORT)
 		{
-			int retVal = THREAD_ABORT;
-			thrd_t testThread; // NOLINT
-			const int result = thrd_create(&testThread, testRunner, currTest);
-			// Check if creating the thread for the test worked or not
-			if (result != thrd_success)
-			{
-				// It did not.. great.. display that and abort
-				red();
-				testPrintf("Test %s failed to start, error code %d. Aborting.", currTest->testName, result);
-				newline();
-				return THREAD_ABORT;
-			}
-			thrd_join(testThread, &retVal);
-			allocCount = -1;
-			if (retVal == THREAD_ABORT)
-				return retVal;
-			++currTest;
+			stopWorker(&worker);
+			return THREAD_ABORT;
 		}
 	}
 
+	stopWorker(&worker);
 	printStats();
 	if (logging)
 		stopLogging(logFile);
@@ -58,6 +58,35 @@ typedef struct _test
 	const char *testName;
 } test;
 
+#if defined(__ELF__) && defined(__GNUC__)
+#include <string.h>
+
+/*
+ * Test libraries built for ELF platforms carry a manifest of the tests they register in their
+ * crunch_manifest section, as a NUL terminated 'C' record per test, so the runner can see what
+ * they hold without loading them. Recording a test takes a statement, so the table of tests is
+ * built on the stack and copied into place rather than being a constant in its own right.
+ */
+#define CRUNCH_MANIFEST_RECORD(kind, text) \
+	__asm__(".pushsection crunch_manifest, \"a\"\n\t.asciz \"" kind text "\"\n\t.popsection")
+
+#define BEGIN_REGISTER_TESTS() \
+CRUNCH_EXPORT void registerTests() \
+{ \
+	const test __testsInit[] = \
+	{ \
+
+#define TEST(name) \
+	{ name, __extension__ ({ CRUNCH_MANIFEST_RECORD("C", #name); #name; }) },
+
+#define END_REGISTER_TESTS() \
+		{ NULL, NULL } \
+	}; \
+	static test __tests[sizeof(__testsInit) / sizeof(test)]; \
+	memcpy(__tests, __testsInit, sizeof(__testsInit)); \
+	tests = __tests; \
+}
+#else
 #define BEGIN_REGISTER_TESTS() \
 CRUNCH_EXPORT void registerTests() \
 { \
@@ -72,6 +101,7 @@ CRUNCH_EXPORT void registerTests() \
 	}; \
 	tests = (test *)__tests; \
 }
+#endif
 
 typedef struct testLog testLog;
 
@@ -99,6 +129,30 @@ CRUNCH_API void assertPtrEqual(void *result, void *expected);
 CRUNCH_API void assertDoubleEqual(double result, double expected);
 CRUNCH_API void assertStringEqual(const char *result, const char *expected);
 CRUNCH_API void assertMemEqual(const void *result, const void *expected, const size_t expectedLength);
+/*
+ * Compares count elements of elementSize bytes each, reporting the index and values of the first
+ * elements that differ along with the elements around them
+ */
+CRUNCH_API void assertRangeEqual(const void *result, const void *expected, size_t count, size_t elementSize);
+/*
+ * Assert that result is no more than maxUlps representable values (units in the last place) away from
+ * expected. Infinities of the same sign are equal, and not a number is never equal to anything.
+ */
+CRUNCH_API void assertFloatUlpEqual(float result, float expected, uint64_t maxUlps);
+CRUNCH_API void assertDoubleUlpEqual(double result, double expected, uint64_t maxUlps);
+CRUNCH_API void assertFloatArrayUlpEqual(const float *result, const float *expected, size_t count, uint64_t maxUlps);
+CRUNCH_API void assertDoubleArrayUlpEqual(const double *result, const double *expected, size_t count,
+	uint64_t maxUlps);
+/*
+ * Assert that result is equal to expected, or differs from it by no more than the larger of the
+ * absolute tolerance and the relative tolerance times the magnitude of expected
+ */
+CRUNCH_API void assertFloatNear(float result, float expected, double relative, double absolute);
+CRUNCH_API void assertDoubleNear(double result, double expected, double relative, double absolute);
+CRUNCH_API void assertFloatArrayNear(const float *result, const float *expected, size_t count, double relative,
+	double absolute);
+CRUNCH_API void assertDoubleArrayNear(const double *result, const double *expected, size_t count, double relative,
+	double absolute);
 
 CRUNCH_API void assertIntNotEqual(int32_t result, int32_t expected);
 CRUNCH_API void assertUintNotEqual(uint32_t result, uint32_t expected);
@@ -119,6 +173,56 @@ CRUNCH_API void assertGreaterThan64(int64_t result, int64_t expected);
 CRUNCH_API void assertLessThan(int32_t result, int32_t expected);
 CRUNCH_API void assertLessThan64(int64_t result, int64_t expected);
 
+/*
+ * Expectations check what the assertions they are named for do, but one that fails is recorded along
+ * with where it was checked and the test carries on. Once the test is over it fails, reporting every
+ * expectation that failed together. Expectations must be checked on the thread running the test.
+ */
+CRUNCH_API void beginExpectation(const char *file, uint32_t line);
+CRUNCH_API void endExpectation(void);
+
+#define CRUNCH_EXPECT(assertion) \
+	do \
+	{ \
+		beginExpectation(__FILE__, __LINE__); \
+		assertion; \
+		endExpectation(); \
+	} while (0)
+
+#define expectTrue(...) CRUNCH_EXPECT(assertTrue(__VA_ARGS__))
+#define expectFalse(...) CRUNCH_EXPECT(assertFalse(__VA_ARGS__))
+
+#define expectIntEqual(...) CRUNCH_EXPECT(assertIntEqual(__VA_ARGS__))
+#define expectInt64Equal(...) CRUNCH_EXPECT(assertInt64Equal(__VA_ARGS__))
+#define expectPtrEqual(...) CRUNCH_EXPECT(assertPtrEqual(__VA_ARGS__))
+#define expectDoubleEqual(...) CRUNCH_EXPECT(assertDoubleEqual(__VA_ARGS__))
+#define expectStringEqual(...) CRUNCH_EXPECT(assertStringEqual(__VA_ARGS__))
+#define expectMemEqual(...) CRUNCH_EXPECT(assertMemEqual(__VA_ARGS__))
+#define expectRangeEqual(...) CRUNCH_EXPECT(assertRangeEqual(__VA_ARGS__))
+#define expectFloatUlpEqual(...) CRUNCH_EXPECT(assertFloatUlpEqual(__VA_ARGS__))
+#define expectDoubleUlpEqual(...) CRUNCH_EXPECT(assertDoubleUlpEqual(__VA_ARGS__))
+#define expectFloatArrayUlpEqual(...) CRUNCH_EXPECT(assertFloatArrayUlpEqual(__VA_ARGS__))
+#define expectDoubleArrayUlpEqual(...) CRUNCH_EXPECT(assertDoubleArrayUlpEqual(__VA_ARGS__))
+#define expectFloatNear(...) CRUNCH_EXPECT(assertFloatNear(__VA_ARGS__))
+#define expectDoubleNear(...) CRUNCH_EXPECT(assertDoubleNear(__VA_ARGS__))
+#define expectFloatArrayNear(...) CRUNCH_EXPECT(assertFloatArrayNear(__VA_ARGS__))
+#define expectDoubleArrayNear(...) CRUNCH_EXPECT(assertDoubleArrayNear(__VA_ARGS__))
+
+#define expectIntNotEqual(...) CRUNCH_EXPECT(assertIntNotEqual(__VA_ARGS__))
+#define expectInt64NotEqual(...) CRUNCH_EXPECT(assertInt64NotEqual(__VA_ARGS__))
+#define expectPtrNotEqual(...) CRUNCH_EXPECT(assertPtrNotEqual(__VA_ARGS__))
+#define expectDoubleNotEqual(...) CRUNCH_EXPECT(assertDoubleNotEqual(__VA_ARGS__))
+#define expectStringNotEqual(...) CRUNCH_EXPECT(assertStringNotEqual(__VA_ARGS__))
+#define expectMemNotEqual(...) CRUNCH_EXPECT(assertMemNotEqual(__VA_ARGS__))
+
+#define expectNull(...) CRUNCH_EXPECT(assertNull(__VA_ARGS__))
+#define expectNotNull(...) CRUNCH_EXPECT(assertNotNull(__VA_ARGS__))
+
+#define expectGreaterThan(...) CRUNCH_EXPECT(assertGreaterThan(__VA_ARGS__))
+#define expectGreaterThan64(...) CRUNCH_EXPECT(assertGreaterThan64(__VA_ARGS__))
+#define expectLessThan(...) CRUNCH_EXPECT(assertLessThan(__VA_ARGS__))
+#define expectLessThan64(...) CRUNCH_EXPECT(assertLessThan64(__VA_ARGS__))
+
 CRUNCH_API test *tests;
 CRUNCH_API int32_t allocCount;
 
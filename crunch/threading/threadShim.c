@@ -56,6 +56,20 @@ int thrd_join(thrd_t thr, int *res)
 }
 
 void thrd_exit(int res) { pthread_exit((void *)(uintptr_t)res); }
+
+int mtx_init(mtx_t *mutex, int type)
+{
+	(void)type;
+	return thrd_err_map(pthread_mutex_init(mutex, NULL));
+}
+
+void mtx_destroy(mtx_t *mutex) { pthread_mutex_destroy(mutex); }
+int mtx_lock(mtx_t *mutex) { return thrd_err_map(pthread_mutex_lock(mutex)); }
+int mtx_unlock(mtx_t *mutex) { return thrd_err_map(pthread_mutex_unlock(mutex)); }
+int cnd_init(cnd_t *cond) { return thrd_err_map(pthread_cond_init(cond, NULL)); }
+void cnd_destroy(cnd_t *cond) { pthread_cond_destroy(cond); }
+int cnd_broadcast(cnd_t *cond) { return thrd_err_map(pthread_cond_broadcast(cond)); }
+int cnd_wait(cnd_t *cond, mtx_t *mutex) { return thrd_err_map(pthread_cond_wait(cond, mutex)); }
 #else
 #include <stdlib.h>
 
@@ -122,4 +136,47 @@ int thrd_join(thrd_t thr, int *res)
 }
 
 void thrd_exit(int res) { ExitThread(res); }
+
+int mtx_init(mtx_t *mutex, int type)
+{
+	(void)type;
+	InitializeCriticalSection(mutex);
+	return thrd_success;
+}
+
+void mtx_destroy(mtx_t *mutex) { DeleteCriticalSection(mutex); }
+
+int mtx_lock(mtx_t *mutex)
+{
+	EnterCriticalSection(mutex);
+	return thrd_success;
+}
+
+int mtx_unlock(mtx_t *mutex)
+{
+	LeaveCriticalSection(mutex);
+	return thrd_success;
+}
+
+int cnd_init(cnd_t *cond)
+{
+	InitializeConditionVariable(cond);
+	return thrd_success;
+}
+
+// Windows condition variables need no clean up
+void cnd_destroy(cnd_t *cond) { (void)cond; }
+
+int cnd_broadcast(cnd_t *cond)
+{
+	WakeAllConditionVariable(cond);
+	return thrd_success;
+}
+
+int cnd_wait(cnd_t *cond, mtx_t *mutex)
+{
+	if (!SleepConditionVariableCS(cond, mutex, INFINITE))
+		return thrd_get_error();
+	return thrd_success;
+}
 #endif
@@ -8,14 +8,24 @@
 #define NORETURN(def) def __attribute((noreturn))
 #endif
 
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
 #ifndef USE_C11_THREADING
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 typedef HANDLE thrd_t;
+typedef CRITICAL_SECTION mtx_t;
+typedef CONDITION_VARIABLE cnd_t;
 #else
 #include <pthread.h>
 typedef pthread_t thrd_t;
+typedef pthread_mutex_t mtx_t;
+typedef pthread_cond_t cnd_t;
 #endif
 #include <crunch.h>
 
@@ -28,11 +38,25 @@ enum
 	thrd_timedout = 4
 };
 
+enum
+{
+	mtx_plain = 0
+};
+
 typedef int (*thrd_start_t)(void *);
 CRUNCH_API int thrd_create(thrd_t *thr, thrd_start_t func, void *arg);
 CRUNCH_API int thrd_join(thrd_t thr, int *res);
 NORETURN(void thrd_exit(int res));
 
+CRUNCH_API int mtx_init(mtx_t *mutex, int type);
+CRUNCH_API void mtx_destroy(mtx_t *mutex);
+CRUNCH_API int mtx_lock(mtx_t *mutex);
+CRUNCH_API int mtx_unlock(mtx_t *mutex);
+CRUNCH_API int cnd_init(cnd_t *cond);
+CRUNCH_API void cnd_destroy(cnd_t *cond);
+CRUNCH_API int cnd_broadcast(cnd_t *cond);
+CRUNCH_API int cnd_wait(cnd_t *cond, mtx_t *mutex);
+
 #ifdef _WIN32
 extern int thrd_get_error(void);
 #else
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: LGPL-3.0-or-later
+# Runs the command given after '--', then reads back the report it wrote with --reporter and checks
+# it holds a record of each test with the outcome and message expected
+from argparse import ArgumentParser
+from json import load as loadJSON
+from subprocess import run
+from sys import argv, exit
+from xml.etree.ElementTree import parse as parseXML
+
+parser = ArgumentParser(description = 'Checks the report written by a crunch++ run')
+parser.add_argument('--format', choices = ['junit', 'json'], required = True, help = 'The format of the report')
+parser.add_argument('--report', required = True, help = 'The report file the command writes')
+parser.add_argument('--exit', type = int, default = 0, help = 'The exit status the command must end with')
+parser.add_argument('--test', action = 'append', default = [], nargs = 3, metavar = ('SUITE::TEST', 'OUTCOME', 'MESSAGE'),
+	help = 'A test the report must record, with its outcome (passed, failed or skipped) and message, if any')
+
+if '--' not in argv:
+	parser.error('no command given to run')
+split = argv.index('--')
+args = parser.parse_args(argv[1:split])
+command = argv[split + 1:]
+
+result = run(command)
+if result.returncode != args.exit:
+	print(f'Check failed: expected exit status {args.exit}, got {result.returncode}')
+	exit(1)
+
+# Reads the report as a list of (Suite::test, outcome, duration, message), which fails if it is malformed
+def readJUnit(fileName):
+	records = []
+	root = parseXML(fileName).getroot()
+	assert root.tag == 'testsuites', f'expected a <testsuites> root, got <{root.tag}>'
+	for suite in root.iter('testsuite'):
+		for case in suite.iter('testcase'):
+			# The class name is the library and test class, separated by a '.'
+			_, className = case.get('classname').split('.', 1)
+			failure = case.find('failure')
+			skipped = case.find('skipped')
+			outcome, message = ('failed', failure.get('message')) if failure is not None else \
+				('skipped', skipped.get('message')) if skipped is not None else ('passed', '')
+			records.append((f'{className}::{case.get("name")}', outcome, float(case.get('time')), message))
+	return records
+
+def readJSON(fileName):
+	with open(fileName, 'r', encoding = 'utf-8') as file:
+		report = loadJSON(file)
+	records = [
+		(f'{test["suite"]}::{test["test"]}', test['outcome'], test['wallTime'] / 1e9, test.get('message', ''))
+		for test in report['tests']
+	]
+	summary = report['summary']
+	assert summary['total'] == len(records), f'summary counts {summary["total"]} tests, report has {len(records)}'
+	failures = sum(1 for record in records if record[1] == 'failed')
+	assert summary['failures'] == failures, f'summary counts {summary["failures"]} failures, report has {failures}'
+	return records
+
+try:
+	records = readJUnit(args.report) if args.format == 'junit' else readJSON(args.report)
+except Exception as error:
+	print(f'Check failed: could not read the {args.format} report {args.report}: {error!r}')
+	exit(1)
+
+failed = False
+def check(condition, message):
+	global failed
+	if not condition:
+		print(f'Check failed: {message}')
+		failed = True
+
+check(len(records) == len(args.test), f'expected {len(args.test)} tests in the report, got {len(records)}')
+for name, outcome, message in args.test:
+	matches = [record for record in records if record[0] == name]
+	check(len(matches) == 1, f'expected one record of {name}, got {len(matches)}')
+	for record in matches:
+		check(record[1] == outcome, f'expected {name} to have {outcome}, got {record[1]}')
+		check(record[2] >= 0, f'expected {name} to have a duration, got {record[2]}')
+		check(record[3] == message, f'expected {name} to have message {message!r}, got {record[3]!r}')
+exit(1 if failed else 0)
@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: LGPL-3.0-or-later
+# Runs the command given after '--' and checks its exit status and what it printed
+from argparse import ArgumentParser
+from re import MULTILINE, findall, search
+from subprocess import run, PIPE, STDOUT
+from sys import argv, exit
+
+parser = ArgumentParser(description = 'Checks the exit status and output of a crunch run')
+parser.add_argument('--exit', type = int, default = 0, help = 'The exit status the command must end with')
+parser.add_argument('--expect', action = 'append', default = [], metavar = 'REGEX',
+	help = 'A pattern the output must match')
+parser.add_argument('--reject', action = 'append', default = [], metavar = 'REGEX',
+	help = 'A pattern the output must not match')
+parser.add_argument('--count', action = 'append', default = [], nargs = 2, metavar = ('COUNT', 'REGEX'),
+	help = 'A pattern the output must match exactly COUNT times')
+
+if '--' not in argv:
+	parser.error('no command given to run')
+split = argv.index('--')
+args = parser.parse_args(argv[1:split])
+command = argv[split + 1:]
+
+result = run(command, stdout = PIPE, stderr = STDOUT)
+output = result.stdout.decode('utf-8', errors = 'replace')
+print(output)
+
+failed = False
+def check(condition, message):
+	global failed
+	if not condition:
+		print(f'Check failed: {message}')
+		failed = True
+
+check(result.returncode == args.exit, f'expected exit status {args.exit}, got {result.returncode}')
+for pattern in args.expect:
+	check(search(pattern, output, MULTILINE), f'expected output matching {pattern!r}')
+for pattern in args.reject:
+	check(not search(pattern, output, MULTILINE), f'did not expect output matching {pattern!r}')
+for count, pattern in args.count:
+	matches = len(findall(pattern, output, MULTILINE))
+	check(matches == int(count), f'expected {count} matches of {pattern!r}, got {matches}')
+exit(1 if failed else 0)
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <cstdio>
+#include <iostream>
+
+// These suites must be run with --capture. The tests are all chatty, but only testFailure fails, so
+// only what it writes should reach the console, alongside its failure.
+class captureTests final : public testsuite
+{
+private:
+	void testStdout()
+	{
+		for (uint32_t i{0}; i < 10000U; ++i)
+			printf("Line %u of output from a passing test\n", i);
+		assertTrue(true);
+	}
+
+	void testStderr()
+	{
+		fputs("Error output from a passing test\n", stderr);
+		std::cerr << "More error output from a passing test" << std::endl;
+		assertTrue(true);
+	}
+
+	void testSkip()
+	{
+		puts("Output from a skipped test");
+		skip("Skipped tests don't have their output shown either");
+	}
+
+	void testFailure()
+	{
+		puts("Output from a failing test");
+		fputs("Error output from a failing test\n", stderr);
+		fail("This test is meant to fail");
+	}
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(captureTests()) = default;
+	captureTests(const captureTests &) = delete;
+	captureTests(captureTests &&) = delete;
+	captureTests &operator =(const captureTests &) = delete;
+	captureTests &operator =(captureTests &&) = delete;
+	~captureTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testStdout)
+		CRUNCHpp_TEST(testStderr)
+		CRUNCHpp_TEST(testSkip)
+		CRUNCHpp_TEST(testFailure)
+	}
+};
+
+CRUNCHpp_TESTS(captureTests)
@@ -2,6 +2,8 @@
 #include <crunch++.h>
 #include <cstdint>
 #include <climits>
+#include <cmath>
+#include <limits>
 #include <sys/types.h>
 #include <sys/stat.h>
 #ifndef _WIN32
@@ -9,12 +11,16 @@
 #else
 #include <io.h>
 #endif
+#include <array>
 #include <memory>
 #include <random>
+#include <string>
+#include <vector>
 #include <functional>
 #include <core.hxx>
 #include <stringFuncs.hxx>
 #include <logger.hxx>
+#include <expectations.hxx>
 
 using std::default_random_engine;
 using std::uniform_real_distribution;
@@ -27,6 +33,24 @@ using crunch::failures;
 enum class testEnum_t
 	{ a, b, c, d };
 
+// A type the assertions only know how to compare and describe through operator == and crunch::printable_t<>
+struct point_t final
+{
+	int32_t x;
+	int32_t y;
+
+	bool operator ==(const point_t &other) const noexcept { return x == other.x && y == other.y; }
+};
+
+namespace crunch
+{
+	template<> struct printable_t<point_t>
+	{
+		static std::string print(const point_t &point)
+			{ return "(" + std::to_string(point.x) + ", " + std::to_string(point.y) + ")"; }
+	};
+} // namespace crunch
+
 constexpr static auto testStr1{"abcdefghijklmnopqrstuvwxyz"_sv};
 constexpr static auto testStr2{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"_sv};
 
@@ -249,6 +273,31 @@ private:
 		tryShouldFail([=]() { assertNotEqual(ptr, ptr); });
 	}
 
+	void testAssertPrintableEqual()
+	{
+		const point_t origin{0, 0};
+		const point_t point{3, 4};
+		assertEqual(origin, origin);
+		assertEqual(point, point_t{3, 4});
+		tryShouldFail([=]() { assertEqual(origin, point); });
+		tryShouldFail([=]() { assertEqual(point, point_t{4, 3}); });
+		// Check the failure describes the values with printable_t<>
+		expectEqual(origin, point);
+		assertTrue(reportExpectations(false).find(": expected (3, 4), got (0, 0)\n") != std::string::npos);
+	}
+
+	void testAssertPrintableNotEqual()
+	{
+		const point_t origin{0, 0};
+		const point_t point{3, 4};
+		assertNotEqual(origin, point);
+		assertNotEqual(point, point_t{4, 3});
+		tryShouldFail([=]() { assertNotEqual(point, point); });
+		tryShouldFail([=]() { assertNotEqual(origin, point_t{0, 0}); });
+		expectNotEqual(point, point);
+		assertTrue(reportExpectations(false).find(": did not expect (3, 4)\n") != std::string::npos);
+	}
+
 	void testAssertStrEqual()
 	{
 		assertEqual(testStr1.data(), testStr1.data());
@@ -284,6 +333,18 @@ private:
 		assertEqual(testStr1.data(), testStr1.data(), 27);
 		assertEqual(testStr2.data(), testStr2.data(), 27);
 		tryShouldFail([=]() { assertEqual(testStr1.data(), testStr2.data(), 27); });
+		std::array<uint8_t, 100> bufferA{};
+		auto bufferB{bufferA};
+		bufferB[70] = 1;
+		bufferB[99] = 1;
+		tryShouldFail([&]() { assertEqual(bufferA.data(), bufferB.data(), bufferA.size()); });
+		// Check the failure reports where the buffers first differ, and how many of their bytes do
+		expectEqual(bufferA.data(), bufferB.data(), bufferA.size());
+		assertTrue(reportExpectations(false).find(" first differ at offset 70, 2 of 100 bytes differ") !=
+			std::string::npos);
+		expectEqual(testStr1.data(), testStr2.data(), 27);
+		assertTrue(reportExpectations(false).find(" first differ at offset 0, 26 of 27 bytes differ") !=
+			std::string::npos);
 	}
 
 	void testAssertMemNotEqual()
@@ -293,6 +354,161 @@ private:
 		tryShouldFail([=]() { assertNotEqual(testStr2.data(), testStr2.data(), 27); });
 	}
 
+	void testAssertRangeEqual()
+	{
+		std::vector<uint32_t> values(100);
+		for (size_t i = 0; i < values.size(); ++i)
+			values[i] = uint32_t(i * 7U);
+		auto copy{values};
+		assertRangeEqual(values, copy);
+		assertRangeEqual(values.data(), copy.data(), values.size());
+		const std::array<int16_t, 3> signedValues{{-1, 0, 1}};
+		assertRangeEqual(signedValues, signedValues);
+		const std::array<testEnum_t, 2> enumsA{{testEnum_t::a, testEnum_t::b}};
+		const std::array<testEnum_t, 2> enumsB{{testEnum_t::a, testEnum_t::c}};
+		tryShouldFail([&]() { assertRangeEqual(enumsA, enumsB); });
+		copy[37] = 0;
+		tryShouldFail([&]() { assertRangeEqual(values, copy); });
+		copy.pop_back();
+		tryShouldFail([&]() { assertRangeEqual(values, copy); });
+	}
+
+	void testAssertUlpEqual()
+	{
+		assertUlpEqual(1.0f, std::nextafter(1.0f, 2.0f), 1);
+		assertUlpEqual(0.0f, -0.0f, 0);
+		assertUlpEqual(1e300, std::nextafter(std::nextafter(1e300, 0.0), 0.0), 2);
+		assertUlpEqual(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), 0);
+		tryShouldFail([this]() { assertUlpEqual(1.0f, std::nextafter(1.0f, 2.0f), 0); });
+		tryShouldFail([this]() { assertUlpEqual(std::nan(""), std::nan(""), 4); });
+		tryShouldFail([this]() { assertUlpEqual(std::numeric_limits<float>::denorm_min(),
+			-std::numeric_limits<float>::denorm_min(), 1); });
+
+		// Check differences are found both in the blocks compared together and in the tail after them
+		std::vector<float> floats(1003);
+		for (size_t i = 0; i < floats.size(); ++i)
+			floats[i] = float(i) * 0.25f - 100.0f;
+		auto floatsCopy{floats};
+		assertUlpEqual(floats, floatsCopy, 0);
+		for (const size_t index : {1U, 500U, 1002U})
+		{
+			floatsCopy[index] = std::nextafter(floatsCopy[index], 1e9f);
+			assertUlpEqual(floats, floatsCopy, 1);
+			tryShouldFail([&]() { assertUlpEqual(floats, floatsCopy, 0); });
+			floatsCopy[index] = floats[index];
+		}
+		std::vector<double> doubles(floats.begin(), floats.end());
+		auto doublesCopy{doubles};
+		doublesCopy[7] = -doublesCopy[7];
+		tryShouldFail([&]() { assertUlpEqual(doubles, doublesCopy); });
+		doublesCopy.pop_back();
+		tryShouldFail([&]() { assertUlpEqual(doubles, doublesCopy); });
+	}
+
+	void testAssertNear()
+	{
+		assertNear(1e20, 1.000001e20, 1e-5);
+		assertNear(1e-20, 1.1e-20, 0.1);
+		assertNear(0.0f, 1e-9f, 0.0, 1e-8);
+		assertNear(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), 0.0);
+		tryShouldFail([this]() { assertNear(1e-20, 2e-20, 0.1); });
+		tryShouldFail([this]() { assertNear(5.0, std::numeric_limits<double>::infinity(), 1.0); });
+		tryShouldFail([this]() { assertNear(std::nanf(""), std::nanf(""), 1.0, 1.0); });
+
+		std::vector<float> floats(1003);
+		for (size_t i = 0; i < floats.size(); ++i)
+			floats[i] = float(i) * 0.25f + 1.0f;
+		auto floatsCopy{floats};
+		for (auto &value : floatsCopy)
+			value *= 1.0001f;
+		assertNear(floats, floatsCopy, 1e-3);
+		tryShouldFail([&]() { assertNear(floats, floatsCopy, 1e-5); });
+		floatsCopy = floats;
+		floatsCopy[1001] = 0.0f;
+		tryShouldFail([&]() { assertNear(floats, floatsCopy, 1e-3); });
+		std::vector<double> doubles(floats.begin(), floats.end());
+		auto doublesCopy{doubles};
+		doublesCopy[2] += 0.5;
+		assertNear(doubles.data(), doublesCopy.data(), 2, 0.0);
+		tryShouldFail([&]() { assertNear(doubles, doublesCopy, 0.01); });
+		doublesCopy[2] = std::nan("");
+		tryShouldFail([&]() { assertNear(doubles, doublesCopy, 1.0); });
+	}
+
+	// Reports the expectations that have failed so far, returning what was printed of them
+	std::string reportExpectations(const bool alreadyFailed)
+	{
+		std::string output{};
+		crunch::captureOutput(&output);
+		const auto reported{crunch::reportExpectations(alreadyFailed)};
+		crunch::captureOutput(nullptr);
+		if (reported && !alreadyFailed)
+			--failures;
+		return output;
+	}
+
+	void testExpectations()
+	{
+		expectTrue(true);
+		expectFalse(false);
+		expectEqual(1, 1);
+		expectEqual(uint64_t{5}, 5);
+		expectEqual(testEnum_t::a, testEnum_t::a);
+		expectEqual(0.5, 0.5);
+		expectEqual(testStr1.data(), testStr1.data());
+		expectEqual(testStdString1, testStdString1);
+		expectEqual(testStr1.data(), testStr1.data(), testStr1.length());
+		expectNotEqual(1, 2);
+		expectNotEqual(testStdString1, testStdString2);
+		expectNull(nullptr);
+		expectNotNull(this);
+		expectGreaterThan(2, 1);
+		expectLessThan(1, 2);
+		expectUlpEqual(1.0f, std::nextafter(1.0f, 2.0f), 1);
+		expectNear(100.0, 100.5, 0.01);
+		assertTrue(reportExpectations(false).empty());
+
+		const std::array<uint32_t, 4> valuesA{{1, 2, 3, 4}};
+		const std::array<uint32_t, 4> valuesB{{1, 2, 5, 4}};
+		// Check the test carries on past each one that fails, and that they are reported in order where they were
+		const auto firstLine{__LINE__ + 1};
+		expectTrue(false);
+		expectEqual(1, 2);
+		expectEqual(testStr1.data(), testStr2.data());
+		expectNotNull(nullptr);
+		expectRangeEqual(valuesA.data(), valuesB.data(), valuesA.size());
+		expectNear(1.0, 2.0, 0.1);
+		const auto output{reportExpectations(false)};
+		assertTrue(output.find("6 expectations failed") != std::string::npos);
+		assertTrue(output.find("testCrunch++.cpp:" + std::to_string(firstLine) + ": expected true, got false\n") !=
+			std::string::npos);
+		assertTrue(output.find(":" + std::to_string(firstLine + 1) + ": expected 2, got 1\n") != std::string::npos);
+		assertTrue(output.find("Assertion failure") == std::string::npos);
+		assertTrue(output.find(": ranges first differ at index 2, expected 5, got 3\n") != std::string::npos);
+		assertTrue(output.find("off by 1 with 0.2 allowed") != std::string::npos);
+		assertTrue(reportExpectations(false).empty());
+
+		// A test that fails an expectation many times over only has the first so many reported in full
+		for (size_t i = 0; i < 1000; ++i)
+			expectEqual(i, i + 1);
+		assertTrue(reportExpectations(true).find("1000 expectations failed before that:") != std::string::npos);
+		crunch::discardExpectations();
+	}
+
+	void testFirstMismatch()
+	{
+		std::vector<uint8_t> bytesA(67);
+		auto bytesB{bytesA};
+		assertEqual(crunch::internal::firstMismatch(bytesA.data(), bytesB.data(), bytesA.size()), bytesA.size());
+		// Check differences are found both in the blocks compared together and in the tail after them
+		for (const size_t offset : {0U, 5U, 15U, 16U, 47U, 63U, 64U, 66U})
+		{
+			bytesB[offset] = 1;
+			assertEqual(crunch::internal::firstMismatch(bytesA.data(), bytesB.data(), bytesA.size()), offset);
+			bytesB[offset] = 0;
+		}
+	}
+
 	void testAssertNull()
 	{
 		assertNull(nullptr);
@@ -427,10 +643,17 @@ public:
 		CRUNCHpp_TEST(testAssertDoubleNotEqual)
 		CRUNCHpp_TEST(testAssertPtrEqual)
 		CRUNCHpp_TEST(testAssertPtrNotEqual)
+		CRUNCHpp_TEST(testAssertPrintableEqual)
+		CRUNCHpp_TEST(testAssertPrintableNotEqual)
 		CRUNCHpp_TEST(testAssertStrEqual)
 		CRUNCHpp_TEST(testAssertStrNotEqual)
 		CRUNCHpp_TEST(testAssertMemEqual)
 		CRUNCHpp_TEST(testAssertMemNotEqual)
+		CRUNCHpp_TEST(testAssertRangeEqual)
+		CRUNCHpp_TEST(testFirstMismatch)
+		CRUNCHpp_TEST(testAssertUlpEqual)
+		CRUNCHpp_TEST(testAssertNear)
+		CRUNCHpp_TEST(testExpectations)
 		CRUNCHpp_TEST(testAssertNull)
 		CRUNCHpp_TEST(testAssertNotNull)
 		CRUNCHpp_TEST(testAssertGreaterThan)
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <array>
+#include <cstdio>
+#include <string>
+#include <daemon.hxx>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using crunch::parseRequest;
+using crunch::testRequest_t;
+#ifndef _WIN32
+using crunch::fileStamp_t;
+#endif
+
+class daemonTests final : public testsuite
+{
+private:
+	void testParseRun()
+	{
+		testRequest_t request{};
+		assertTrue(parseRequest("run testLibrary", request));
+		assertFalse(request.quit);
+		assertEqual(request.library, "testLibrary");
+		assertTrue(request.patterns.empty());
+
+		testRequest_t filtered{};
+		assertTrue(parseRequest("  run\ttestLibrary  *::testRun*   -suite::testSlow ", filtered));
+		assertFalse(filtered.quit);
+		assertEqual(filtered.library, "testLibrary");
+		assertEqual(filtered.patterns.size(), 2U);
+		assertEqual(filtered.patterns[0], "*::testRun*");
+		assertEqual(filtered.patterns[1], "-suite::testSlow");
+	}
+
+	void testParseQuit()
+	{
+		testRequest_t request{};
+		assertTrue(parseRequest("quit", request));
+		assertTrue(request.quit);
+		testRequest_t padded{};
+		assertTrue(parseRequest(" quit ", padded));
+		assertTrue(padded.quit);
+	}
+
+	void testParseInvalid()
+	{
+		for (const auto *const line : {"", "   ", "run", "run ", "quit now", "walk testLibrary", "RUN testLibrary"})
+		{
+			testRequest_t request{};
+			assertFalse(parseRequest(line, request));
+			assertFalse(request.quit);
+		}
+	}
+
+#ifndef _WIN32
+	static fileStamp_t stamp(const char *const path)
+	{
+		struct stat file{};
+		if (stat(path, &file))
+			return {};
+		return fileStamp_t::of(file);
+	}
+
+	void writeFile(const char *const path, const char *const contents)
+	{
+		auto *const file{fopen(path, "wb")};
+		assertNotNull(file);
+		fputs(contents, file);
+		fclose(file);
+	}
+
+	void testStampUnchanged()
+	{
+		writeFile("daemonUnchanged.tmp", "library");
+		const auto before{stamp("daemonUnchanged.tmp")};
+		const auto after{stamp("daemonUnchanged.tmp")};
+		remove("daemonUnchanged.tmp");
+		assertTrue(before == after);
+		assertFalse(before != after);
+	}
+
+	void testStampRewritten()
+	{
+		writeFile("daemonRewritten.tmp", "library");
+		const auto before{stamp("daemonRewritten.tmp")};
+		writeFile("daemonRewritten.tmp", "rebuilt library");
+		const auto after{stamp("daemonRewritten.tmp")};
+		remove("daemonRewritten.tmp");
+		assertTrue(before != after);
+	}
+
+	void testStampTouched()
+	{
+		writeFile("daemonTouched.tmp", "library");
+		const auto before{stamp("daemonTouched.tmp")};
+		// Same size, same file, but written again later on
+		const std::array<timespec, 2> times{{{0, UTIME_OMIT}, {before.modified.tv_sec + 1, before.modified.tv_nsec}}};
+		const auto touched{utimensat(AT_FDCWD, "daemonTouched.tmp", times.data(), 0)};
+		const auto after{stamp("daemonTouched.tmp")};
+		remove("daemonTouched.tmp");
+		assertEqual(touched, 0);
+		assertTrue(before != after);
+	}
+
+	void testStampReplaced()
+	{
+		writeFile("daemonReplaced.tmp", "library");
+		writeFile("daemonReplaced.new", "library");
+		const auto before{stamp("daemonReplaced.tmp")};
+		// A library moved in over the old one is a different file, even if nothing else about it differs
+		const auto moved{rename("daemonReplaced.new", "daemonReplaced.tmp")};
+		auto after{stamp("daemonReplaced.tmp")};
+		remove("daemonReplaced.tmp");
+		assertEqual(moved, 0);
+		assertTrue(before != after);
+		after.inode = before.inode;
+		after.modified = before.modified;
+		assertTrue(before == after);
+	}
+
+	void testResidentNeedsFile()
+	{
+		// libcrunch++ is loaded, so dlopen() would hand it back by name, but there's no file by that name
+		// here to check it against for being rebuilt, so the daemon must not take it
+		assertNull(crunch::residentLibrary("libcrunch++.so"));
+		assertNull(crunch::residentLibrary("daemonMissing.so"));
+	}
+#endif
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(daemonTests()) = default;
+	daemonTests(const daemonTests &) = delete;
+	daemonTests(daemonTests &&) = delete;
+	daemonTests &operator =(const daemonTests &) = delete;
+	daemonTests &operator =(daemonTests &&) = delete;
+	~daemonTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testParseRun)
+		CRUNCHpp_TEST(testParseQuit)
+		CRUNCHpp_TEST(testParseInvalid)
+#ifndef _WIN32
+		CRUNCHpp_TEST(testStampUnchanged)
+		CRUNCHpp_TEST(testStampRewritten)
+		CRUNCHpp_TEST(testStampTouched)
+		CRUNCHpp_TEST(testStampReplaced)
+		CRUNCHpp_TEST(testResidentNeedsFile)
+#endif
+	}
+};
+
+CRUNCHpp_TESTS(daemonTests)
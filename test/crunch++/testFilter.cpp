@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+
+// These suites must be run with --filter '*::testRun*' --tag fast --tag -broken. Every test
+// the filters exclude fails, so the run only passes if none of them are run.
+class filterTests final : public testsuite
+{
+private:
+	void testRunTagged() { assertTrue(true); }
+	void testRunUntagged() { fail("--tag fast should have excluded this test"); }
+	void testExcludedByName() { fail("--filter should have excluded this test"); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(filterTests()) = default;
+	filterTests(const filterTests &) = delete;
+	filterTests(filterTests &&) = delete;
+	filterTests &operator =(const filterTests &) = delete;
+	filterTests &operator =(filterTests &&) = delete;
+	~filterTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TAGGED_TEST(testRunTagged, "fast")
+		CRUNCHpp_TEST(testRunUntagged)
+		CRUNCHpp_TAGGED_TEST(testExcludedByName, "fast")
+	}
+};
+
+class tagTests final : public testsuite
+{
+private:
+	void testRunFast() { assertEqual(6 * 7, 42); }
+	void testRunSlow() { fail("--tag fast should have excluded this test"); }
+	void testRunBroken() { fail("--tag -broken should have excluded this test"); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(tagTests()) = default;
+	tagTests(const tagTests &) = delete;
+	tagTests(tagTests &&) = delete;
+	tagTests &operator =(const tagTests &) = delete;
+	tagTests &operator =(tagTests &&) = delete;
+	~tagTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TAGGED_TEST(testRunFast, "fast, unit")
+		CRUNCHpp_TAGGED_TEST(testRunSlow, "slow")
+		CRUNCHpp_TAGGED_TEST(testRunBroken, "fast,broken")
+	}
+};
+
+// As tagTests, but registered from a test table, which must be filtered just the same
+class tableTagTests final : public testsuite
+{
+private:
+	void testRunFastTable() { assertEqual(6 * 7, 42); }
+	void testRunSlowTable() { fail("--tag fast should have excluded this test"); }
+	void testRunBrokenTable() { fail("--tag -broken should have excluded this test"); }
+	void testRunUntaggedTable() { fail("--tag fast should have excluded this test"); }
+	void testUntaggedTable() { fail("--filter should have excluded this test"); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(tableTagTests()) = default;
+	tableTagTests(const tableTagTests &) = delete;
+	tableTagTests(tableTagTests &&) = delete;
+	tableTagTests &operator =(const tableTagTests &) = delete;
+	tableTagTests &operator =(tableTagTests &&) = delete;
+	~tableTagTests() noexcept final = default;
+
+	CRUNCHpp_TEST_TABLE(
+		CRUNCHpp_TABLE_TAGGED_TEST(testRunFastTable, "fast, unit"),
+		CRUNCHpp_TABLE_TAGGED_TEST(testRunSlowTable, "slow"),
+		CRUNCHpp_TABLE_TAGGED_TEST(testRunBrokenTable, "fast,broken"),
+		CRUNCHpp_TABLE_TEST(testRunUntaggedTable),
+		CRUNCHpp_TABLE_TEST(testUntaggedTable)
+	)
+};
+
+CRUNCHpp_TESTS(filterTests, tagTests, tableTagTests)
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <csignal>
+
+// This suite must be run with --isolate, as testCrash takes down the process running it.
+// The run is expected to fail with exactly one failure - the crash - and the tests after
+// it must still run and pass.
+class isolationTests final : public testsuite
+{
+private:
+	void testBefore() { assertTrue(true); }
+
+	void testCrash()
+	{
+		std::raise(SIGSEGV);
+		fail("Survived raising SIGSEGV");
+	}
+
+	void testAfter() { assertEqual(6 * 7, 42); }
+
+	void testSkip()
+		{ skip("Skipping in a worker process"); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(isolationTests()) = default;
+	isolationTests(const isolationTests &) = delete;
+	isolationTests(isolationTests &&) = delete;
+	isolationTests &operator =(const isolationTests &) = delete;
+	isolationTests &operator =(isolationTests &&) = delete;
+	~isolationTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testBefore)
+		CRUNCHpp_TEST(testCrash)
+		CRUNCHpp_TEST(testAfter)
+		CRUNCHpp_TEST(testSkip)
+		CRUNCHpp_TEST(testAfter)
+	}
+};
+
+CRUNCHpp_TESTS(isolationTests)
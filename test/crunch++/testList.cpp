@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <cstdio>
+
+// These are only ever listed, never run, and say so when they are constructed so the listing can be
+// checked to have left alone those it could name the tests of without constructing them
+
+class listTests final : public testsuite
+{
+private:
+	void testFirst() { fail("Listed tests must not be run"); }
+	void testSecond() { fail("Listed tests must not be run"); }
+	void testTagged() { fail("Listed tests must not be run"); }
+
+public:
+	listTests() noexcept { puts("Constructed listTests"); }
+	listTests(const listTests &) = delete;
+	listTests(listTests &&) = delete;
+	listTests &operator =(const listTests &) = delete;
+	listTests &operator =(listTests &&) = delete;
+	~listTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testFirst)
+		CRUNCHpp_TEST(testSecond)
+		CRUNCHpp_TAGGED_TEST(testTagged, "slow")
+	}
+};
+
+class listTableTests final : public testsuite
+{
+private:
+	void testTable() { fail("Listed tests must not be run"); }
+	void testTaggedTable() { fail("Listed tests must not be run"); }
+
+public:
+	listTableTests() noexcept { puts("Constructed listTableTests"); }
+	listTableTests(const listTableTests &) = delete;
+	listTableTests(listTableTests &&) = delete;
+	listTableTests &operator =(const listTableTests &) = delete;
+	listTableTests &operator =(listTableTests &&) = delete;
+	~listTableTests() noexcept final = default;
+
+	CRUNCHpp_TEST_TABLE(
+		CRUNCHpp_TABLE_TEST(testTable),
+		CRUNCHpp_TABLE_TAGGED_TEST(testTaggedTable, "slow")
+	)
+};
+
+// Tests registered other than through the macros can only be found by constructing the class
+class directListTests final : public testsuite
+{
+private:
+	void testDirect() { fail("Listed tests must not be run"); }
+
+public:
+	directListTests() noexcept { puts("Constructed directListTests"); }
+	directListTests(const directListTests &) = delete;
+	directListTests(directListTests &&) = delete;
+	directListTests &operator =(const directListTests &) = delete;
+	directListTests &operator =(directListTests &&) = delete;
+	~directListTests() noexcept final = default;
+
+	void registerTests() final
+		{ registerTest([this]() { testDirect(); }, "testDirect"); }
+};
+
+CRUNCHpp_TESTS(listTests, listTableTests, directListTests)
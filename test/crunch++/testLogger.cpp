@@ -9,6 +9,7 @@
 #include <substrate/pipe>
 #include <fcntl.h>
 #include <logger.hxx>
+#include <output.hxx>
 #include <core.hxx>
 
 using crunch::literals::operator ""_sv;
@@ -94,6 +95,7 @@ private:
 		assertEqual(dup2(pipe.writeFD(), stderrFileno), stderrFileno);
 		assertEqual(dup2(pipe.writeFD(), stdoutFileno), stdoutFileno);
 		isTTY = false;
+		crunch::refreshColumns();
 	}
 
 	void swapToPTY()
@@ -102,13 +104,17 @@ private:
 		assertEqual(dup2(pty.pts(), stderrFileno), stderrFileno);
 		assertEqual(dup2(pty.pts(), stdoutFileno), stdoutFileno);
 		isTTY = true;
+		crunch::refreshColumns();
 	}
 
 	void restoreStdio()
 	{
+		// testPrintf() output is buffered, so get it to the pipe or pty before swapping stdout back
+		crunch::flushOutput();
 		assertEqual(dup2(stdoutFD, stdoutFileno), stdoutFileno);
 		assertEqual(dup2(stderrFD, stderrFileno), stderrFileno);
 		isTTY = isatty(stdoutFileno);
+		crunch::refreshColumns();
 	}
 
 	void assertPipeRead(const readPipe_t &fd, const stringView &expected)
@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <manifest.hxx>
+#include <filter.hxx>
+
+using crunch::testManifest_t;
+using crunch::parseManifest;
+using crunch::readManifest;
+using crunch::filtersMayMatch;
+
+// Puts the run's --filter and --tag patterns back however the test using other patterns ends
+struct filtersGuard_t final
+{
+private:
+	std::vector<std::string> names;
+	std::vector<std::string> tags;
+
+public:
+	filtersGuard_t(std::vector<std::string> nameFilters, std::vector<std::string> tagFilters) :
+		names{std::move(nameFilters)}, tags{std::move(tagFilters)}
+	{
+		crunch::nameFilters.swap(names);
+		crunch::tagFilters.swap(tags);
+	}
+	filtersGuard_t(const filtersGuard_t &) = delete;
+	filtersGuard_t(filtersGuard_t &&) = delete;
+	filtersGuard_t &operator =(const filtersGuard_t &) = delete;
+	filtersGuard_t &operator =(filtersGuard_t &&) = delete;
+
+	~filtersGuard_t() noexcept
+	{
+		crunch::nameFilters.swap(names);
+		crunch::tagFilters.swap(tags);
+	}
+};
+
+static bool contains(const std::vector<std::string> &records, const char *const record)
+	{ return std::find(records.begin(), records.end(), record) != records.end(); }
+
+class manifestTests final : public testsuite
+{
+private:
+	void testParse()
+	{
+		// The last record is cut short of its NUL, as if it ran off the end of the section
+		constexpr static char records[]{"Tfirst\0\0Tsecond\0Tfirst\0Cthird\0Xunknown\0Tlast"};
+		const auto manifest{parseManifest(records, sizeof(records) - 1)};
+		assertTrue(manifest.complete);
+		assertTrue(manifest.suites.empty());
+		assertEqual(manifest.tests.size(), 4U);
+		assertEqual(manifest.tests[0], "first");
+		assertEqual(manifest.tests[1], "second");
+		assertEqual(manifest.tests[2], "third");
+		assertEqual(manifest.tests[3], "last");
+	}
+
+	void testParseIncomplete()
+	{
+		constexpr static char records[]{"Tfirst\0U\0Tsecond"};
+		const auto manifest{parseManifest(records, sizeof(records))};
+		assertFalse(manifest.complete);
+		assertEqual(manifest.tests.size(), 2U);
+	}
+
+	void testReadLibrary()
+	{
+		if (!crunch::manifestSupported)
+			skip("Test library manifests can't be read on this platform");
+		const auto manifest{readManifest("testManifest.so")};
+		// The classes are named as the runner names them, whatever they were called in CRUNCHpp_TESTS()
+		assertEqual(manifest.suites.size(), 4U);
+		assertTrue(contains(manifest.suites, "manifestTests"));
+		assertTrue(contains(manifest.suites, "manifest::aliasedTests"));
+		assertTrue(contains(manifest.suites, "directTests"));
+		assertFalse(contains(manifest.suites, "aliasTests"));
+		assertTrue(contains(manifest.tests, "testParse"));
+		assertTrue(contains(manifest.tests, "testReadLibrary"));
+		assertTrue(contains(manifest.tests, "testAliased"));
+		// Table tests are named by the functions they're run through
+		assertTrue(contains(manifest.suites, "tableManifestTests"));
+		assertTrue(contains(manifest.tests, "testTabled"));
+		// directTests registers its test itself, which the manifest can't name, so must say so
+		assertFalse(contains(manifest.tests, "testDirect"));
+		assertFalse(manifest.complete);
+	}
+
+	void testReadMissing()
+	{
+		const auto manifest{readManifest("testMustNotExist.so")};
+		assertTrue(manifest.suites.empty());
+		assertTrue(manifest.tests.empty());
+	}
+
+	void testMayMatch()
+	{
+		testManifest_t manifest{};
+		manifest.suites = {"fooTests", "ns::barTests"};
+		manifest.tests = {"testRun", "testSlow"};
+		assertTrue(manifest.mayMatch("fooTests::testRun"));
+		assertTrue(manifest.mayMatch("ns::barTests::testSlow"));
+		assertTrue(manifest.mayMatch("*::testRun"));
+		assertTrue(manifest.mayMatch("ns::*"));
+		assertFalse(manifest.mayMatch("barTests::testRun"));
+		assertFalse(manifest.mayMatch("fooTests::testOther"));
+		// Without the classes, only the test names can rule a pattern out
+		manifest.suites.clear();
+		assertTrue(manifest.mayMatch("anyTests::testRun"));
+		assertFalse(manifest.mayMatch("anyTests::testOther"));
+	}
+
+	void testPreSkip()
+	{
+		testManifest_t manifest{};
+		manifest.suites = {"fooTests"};
+		manifest.tests = {"testRun"};
+		{
+			const filtersGuard_t filters{{}, {}};
+			assertTrue(filtersMayMatch(manifest));
+		}
+		{
+			const filtersGuard_t filters{{"fooTests::testRun"}, {}};
+			assertTrue(filtersMayMatch(manifest));
+		}
+		{
+			const filtersGuard_t filters{{"barTests::*", "-fooTests::*"}, {}};
+			assertFalse(filtersMayMatch(manifest));
+		}
+		{
+			// Excluding alone selects everything else, which might be in the library
+			const filtersGuard_t filters{{"-fooTests::*"}, {}};
+			assertTrue(filtersMayMatch(manifest));
+		}
+		{
+			// Tags aren't recorded, so the library must be loaded to see what they select
+			const filtersGuard_t filters{{"barTests::*"}, {"fast"}};
+			assertTrue(filtersMayMatch(manifest));
+		}
+		const filtersGuard_t filters{{"barTests::*"}, {}};
+		manifest.complete = false;
+		assertTrue(filtersMayMatch(manifest));
+		assertTrue(filtersMayMatch({}));
+	}
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(manifestTests()) = default;
+	manifestTests(const manifestTests &) = delete;
+	manifestTests(manifestTests &&) = delete;
+	manifestTests &operator =(const manifestTests &) = delete;
+	manifestTests &operator =(manifestTests &&) = delete;
+	~manifestTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testParse)
+		CRUNCHpp_TEST(testParseIncomplete)
+		CRUNCHpp_TEST(testReadLibrary)
+		CRUNCHpp_TEST(testReadMissing)
+		CRUNCHpp_TEST(testMayMatch)
+		CRUNCHpp_TEST(testPreSkip)
+	}
+};
+
+namespace manifest
+{
+	class aliasedTests final : public testsuite
+	{
+	private:
+		void testAliased() { assertTrue(true); }
+
+	public:
+		CRUNCHpp_MAYBE_NOEXCEPT(aliasedTests()) = default;
+		aliasedTests(const aliasedTests &) = delete;
+		aliasedTests(aliasedTests &&) = delete;
+		aliasedTests &operator =(const aliasedTests &) = delete;
+		aliasedTests &operator =(aliasedTests &&) = delete;
+		~aliasedTests() noexcept final = default;
+
+		void registerTests() final
+		{
+			CRUNCHpp_TEST(testAliased)
+		}
+	};
+} // namespace manifest
+
+// Registers its test without the macros, so it can't be named in the manifest
+class directTests final : public testsuite
+{
+private:
+	void testDirect() { assertTrue(true); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(directTests()) = default;
+	directTests(const directTests &) = delete;
+	directTests(directTests &&) = delete;
+	directTests &operator =(const directTests &) = delete;
+	directTests &operator =(directTests &&) = delete;
+	~directTests() noexcept final = default;
+
+	void registerTests() final
+		{ registerTest([this]() { testDirect(); }, "testDirect"); }
+};
+
+class tableManifestTests final : public testsuite
+{
+private:
+	void testTabled() { assertTrue(true); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(tableManifestTests()) = default;
+	tableManifestTests(const tableManifestTests &) = delete;
+	tableManifestTests(tableManifestTests &&) = delete;
+	tableManifestTests &operator =(const tableManifestTests &) = delete;
+	tableManifestTests &operator =(tableManifestTests &&) = delete;
+	~tableManifestTests() noexcept final = default;
+
+	CRUNCHpp_TEST_TABLE(CRUNCHpp_TABLE_TEST(testTabled))
+};
+
+using aliasTests = manifest::aliasedTests;
+CRUNCHpp_TESTS(manifestTests, aliasTests, directTests, tableManifestTests)
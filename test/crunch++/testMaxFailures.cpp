@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+
+// These suites must be run with --max-failures 2. The second failure should stop the run, so the
+// run must report exactly two failures out of three tests, and none of the testNotRun tests.
+class maxFailuresTests final : public testsuite
+{
+private:
+	void testFailure() { fail("This test is meant to fail"); }
+	void testPass() { assertTrue(true); }
+	void testFailureAgain() { fail("This test is meant to fail too"); }
+	void testNotRun() { fail("This test should not run once the run has reached --max-failures"); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(maxFailuresTests()) = default;
+	maxFailuresTests(const maxFailuresTests &) = delete;
+	maxFailuresTests(maxFailuresTests &&) = delete;
+	maxFailuresTests &operator =(const maxFailuresTests &) = delete;
+	maxFailuresTests &operator =(maxFailuresTests &&) = delete;
+	~maxFailuresTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testFailure)
+		CRUNCHpp_TEST(testPass)
+		CRUNCHpp_TEST(testFailureAgain)
+		CRUNCHpp_TEST(testNotRun)
+	}
+};
+
+class notRunTests final : public testsuite
+{
+private:
+	void testNotRun() { fail("This test should not run once the run has reached --max-failures"); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(notRunTests()) = default;
+	notRunTests(const notRunTests &) = delete;
+	notRunTests(notRunTests &&) = delete;
+	notRunTests &operator =(const notRunTests &) = delete;
+	notRunTests &operator =(notRunTests &&) = delete;
+	~notRunTests() noexcept final = default;
+
+	void registerTests() final
+		{ CRUNCHpp_TEST(testNotRun) }
+};
+
+CRUNCHpp_TESTS(maxFailuresTests, notRunTests)
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+// This suite must be run with --jobs 2 or higher, as the rendezvous tests can only
+// succeed when the runner executes them concurrently.
+class parallelTests final : public testsuite
+{
+private:
+	std::mutex rendezvousLock{};
+	std::condition_variable rendezvousCond{};
+	uint32_t arrivals{0};
+
+	void rendezvous()
+	{
+		std::unique_lock<std::mutex> lock{rendezvousLock};
+		++arrivals;
+		rendezvousCond.notify_all();
+		const auto met{rendezvousCond.wait_for(lock, std::chrono::seconds{10},
+			[this]() { return arrivals >= 2; })};
+		lock.unlock();
+		assertTrue(met);
+	}
+
+	void testRendezvousA() { rendezvous(); }
+	void testRendezvousB() { rendezvous(); }
+
+	void testWork()
+	{
+		uint64_t value{0};
+		for (uint32_t i{0}; i < 1000; ++i)
+			value += i;
+		assertEqual(value, 499500U);
+	}
+
+	void testSkip()
+		{ skip("Skipping on a worker thread"); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(parallelTests()) = default;
+	parallelTests(const parallelTests &) = delete;
+	parallelTests(parallelTests &&) = delete;
+	parallelTests &operator =(const parallelTests &) = delete;
+	parallelTests &operator =(parallelTests &&) = delete;
+	~parallelTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testRendezvousA)
+		CRUNCHpp_TEST(testRendezvousB)
+		CRUNCHpp_TEST(testWork)
+		CRUNCHpp_TEST(testWork)
+		CRUNCHpp_TEST(testWork)
+		CRUNCHpp_TEST(testWork)
+		CRUNCHpp_TEST(testSkip)
+		CRUNCHpp_TEST(testWork)
+		CRUNCHpp_TEST(testWork)
+		CRUNCHpp_TEST(testWork)
+		CRUNCHpp_TEST(testWork)
+	}
+};
+
+CRUNCHpp_TESTS(parallelTests)
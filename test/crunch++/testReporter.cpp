@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+
+// These suites must be run with --reporter, and the report they write checked by checkReport.py,
+// which expects one test of each outcome. The run fails, as testAssertion does.
+class reporterTests final : public testsuite
+{
+private:
+	void testPass() { assertTrue(true); }
+	void testAssertion() { assertEqual(6 * 7, 24); }
+	void testSkip() { skip("Skipped to be reported"); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(reporterTests()) = default;
+	reporterTests(const reporterTests &) = delete;
+	reporterTests(reporterTests &&) = delete;
+	reporterTests &operator =(const reporterTests &) = delete;
+	reporterTests &operator =(reporterTests &&) = delete;
+	~reporterTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testPass)
+		CRUNCHpp_TEST(testAssertion)
+		CRUNCHpp_TEST(testSkip)
+	}
+};
+
+CRUNCHpp_TESTS(reporterTests)
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <thread>
+#include <vector>
+#include <results.hxx>
+
+using crunch::testResults_t;
+using crunch::resultShard_t;
+using crunch::cacheLineSize;
+
+class resultsTests final : public testsuite
+{
+private:
+	void testShardLayout()
+	{
+		assertEqual(sizeof(resultShard_t), cacheLineSize);
+		assertEqual(alignof(resultShard_t), cacheLineSize);
+	}
+
+	void testCounting()
+	{
+		testResults_t results{};
+		assertEqual(results.passes.load(), 0U);
+		assertEqual(results.failures.load(), 0U);
+		++results.passes;
+		++results.passes;
+		++results.failures;
+		assertEqual(results.passes.load(), 2U);
+		assertEqual(results.failures.load(), 1U);
+		assertEqual(results.total(), 3U);
+		--results.passes;
+		results.failures += 4U;
+		assertEqual(results.passes.load(), 1U);
+		assertEqual(results.failures.load(), 5U);
+		assertEqual(results.total(), 6U);
+	}
+
+	void testThreadedCounting()
+	{
+		testResults_t results{};
+		constexpr uint32_t threadCount{8U};
+		constexpr uint32_t countsPerThread{10000U};
+		std::vector<std::thread> threads{};
+		for (uint32_t i{0}; i < threadCount; ++i)
+		{
+			threads.emplace_back([&]()
+			{
+				for (uint32_t j{0}; j < countsPerThread; ++j)
+				{
+					++results.passes;
+					if (j & 1U)
+						++results.failures;
+				}
+			});
+		}
+		for (auto &thread : threads)
+			thread.join();
+		assertEqual(results.passes.load(), threadCount * countsPerThread);
+		assertEqual(results.failures.load(), threadCount * countsPerThread / 2U);
+	}
+
+	void testTakeBackAcrossThreads()
+	{
+		testResults_t results{};
+		std::thread counter{[&]() { results.failures += 3U; }};
+		counter.join();
+		// Taking a result back on another thread than counted it must still balance out
+		--results.failures;
+		assertEqual(results.failures.load(), 2U);
+	}
+
+	void testReset()
+	{
+		testResults_t results{};
+		results.passes += 5U;
+		++results.failures;
+		results.reset();
+		assertEqual(results.passes.load(), 0U);
+		assertEqual(results.failures.load(), 0U);
+		assertEqual(results.total(), 0U);
+		++results.failures;
+		assertEqual(results.failures.load(), 1U);
+	}
+
+	void testAdjustments()
+	{
+		std::atomic<uint32_t> passes{0};
+		std::atomic<uint32_t> failures{0};
+		testResults_t results{passes, failures};
+		++results.passes;
+		results.failures += 2U;
+		// Adjusting the counters directly, as older test libraries do, must show in the results
+		--failures;
+		passes += 3U;
+		assertEqual(results.passes.load(), 4U);
+		assertEqual(results.failures.load(), 1U);
+		assertEqual(passes.load(), 3U);
+		results.reset();
+		assertEqual(results.total(), 0U);
+		assertEqual(passes.load(), 0U);
+		assertEqual(failures.load(), 0U);
+	}
+
+public:
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testShardLayout)
+		CRUNCHpp_TEST(testCounting)
+		CRUNCHpp_TEST(testThreadedCounting)
+		CRUNCHpp_TEST(testTakeBackAcrossThreads)
+		CRUNCHpp_TEST(testReset)
+		CRUNCHpp_TEST(testAdjustments)
+	}
+};
+
+CRUNCHpp_TESTS(resultsTests)
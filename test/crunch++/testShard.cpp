@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <cstdio>
+#include <vector>
+#include <shard.hxx>
+#include <history.hxx>
+
+using crunch::shardCount;
+using crunch::shardTimings;
+using crunch::shardsForLibraries;
+using crunch::testHistory;
+using crunch::testHistory_t;
+
+class shardTests final : public testsuite
+{
+private:
+	const std::vector<const char *> libraries{"testSlow", "testA", "testB", "testC", "testD", "testE"};
+
+	// Writes a history in which testSlow takes as long as all the other libraries put together
+	void writeHistory(const char *const fileName)
+	{
+		auto *const file{fopen(fileName, "wb")};
+		assertNotNull(file);
+		fprintf(file, "crunch++ history 1\n");
+		fprintf(file, "test\ttestSlow\tsuite\ttest\t5000\n");
+		for (const auto *const library : {"testA", "testB", "testC", "testD", "testE"})
+			fprintf(file, "test\t%s\tsuite\ttest\t1000\n", library);
+		fclose(file);
+	}
+
+	// Shards the libraries as if the run were split count ways, putting back how the run itself is sharded
+	std::vector<uint32_t> shardLibraries(const uint32_t count) const
+	{
+		const auto runCount{shardCount};
+		shardCount = count;
+		const auto shards{shardsForLibraries(libraries)};
+		shardCount = runCount;
+		return shards;
+	}
+
+	void testHashPlacement()
+	{
+		const auto shards{shardLibraries(3)};
+		assertEqual(shards.size(), libraries.size());
+		for (const auto shard : shards)
+			assertLessThan(shard, 3);
+		assertTrue(shardLibraries(3) == shards);
+	}
+
+	void testLocalHistoryIgnored()
+	{
+		const auto shards{shardLibraries(2)};
+		// Each machine has its own history, so one must never change how the tests are split up
+		writeHistory("shardHistory.db");
+		testHistory_t history{"shardHistory.db"};
+		remove("shardHistory.db");
+		auto *const runHistory{testHistory};
+		testHistory = &history;
+		const auto withHistory{shardLibraries(2)};
+		testHistory = runHistory;
+		assertTrue(withHistory == shards);
+	}
+
+	void testTimingsBalance()
+	{
+		writeHistory("shardTimings.db");
+		const testHistory_t timings{"shardTimings.db"};
+		remove("shardTimings.db");
+		const auto *const runTimings{shardTimings};
+		shardTimings = &timings;
+		const auto shards{shardLibraries(2)};
+		shardTimings = runTimings;
+		// testSlow must get a shard to itself, with every other library on the other
+		for (std::size_t i{1}; i < shards.size(); ++i)
+			assertNotEqual(shards[i], shards[0]);
+	}
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(shardTests()) = default;
+	shardTests(const shardTests &) = delete;
+	shardTests(shardTests &&) = delete;
+	shardTests &operator =(const shardTests &) = delete;
+	shardTests &operator =(shardTests &&) = delete;
+	~shardTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testHashPlacement)
+		CRUNCHpp_TEST(testLocalHistoryIgnored)
+		CRUNCHpp_TEST(testTimingsBalance)
+	}
+};
+
+CRUNCHpp_TESTS(shardTests)
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <chrono>
+#include <thread>
+
+// These suites must be run with the isolation timeouts need available. Each testHang never
+// returns, so must be stopped by the watchdog, and the run is expected to fail because of it
+// with the tests around the hung ones still having run.
+class testTimeoutTests final : public testsuite
+{
+private:
+	void testBefore() { assertTrue(true); }
+
+	void testHang()
+	{
+		while (true)
+			std::this_thread::sleep_for(std::chrono::seconds{1});
+	}
+
+	void testAfter() { assertEqual(6 * 7, 42); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(testTimeoutTests()) = default;
+	testTimeoutTests(const testTimeoutTests &) = delete;
+	testTimeoutTests(testTimeoutTests &&) = delete;
+	testTimeoutTests &operator =(const testTimeoutTests &) = delete;
+	testTimeoutTests &operator =(testTimeoutTests &&) = delete;
+	~testTimeoutTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		// This overrides whatever --timeout the runner was given
+		setTestTimeout(0.25);
+		CRUNCHpp_TEST(testBefore)
+		CRUNCHpp_TEST(testHang)
+		CRUNCHpp_TEST(testAfter)
+	}
+};
+
+class suiteTimeoutTests final : public testsuite
+{
+private:
+	void testBefore() { assertTrue(true); }
+
+	void testHang()
+	{
+		while (true)
+			std::this_thread::sleep_for(std::chrono::seconds{1});
+	}
+
+	void testNeverRun() { fail("The suite should have run out of time before this test"); }
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(suiteTimeoutTests()) = default;
+	suiteTimeoutTests(const suiteTimeoutTests &) = delete;
+	suiteTimeoutTests(suiteTimeoutTests &&) = delete;
+	suiteTimeoutTests &operator =(const suiteTimeoutTests &) = delete;
+	suiteTimeoutTests &operator =(suiteTimeoutTests &&) = delete;
+	~suiteTimeoutTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		setTestTimeout(0);
+		setSuiteTimeout(0.5);
+		CRUNCHpp_TEST(testBefore)
+		CRUNCHpp_TEST(testHang)
+		CRUNCHpp_TEST(testNeverRun)
+	}
+};
+
+CRUNCHpp_TESTS(testTimeoutTests, suiteTimeoutTests)
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <crunch++.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <watch.hxx>
+
+using crunch::libraryWatcher_t;
+using crunch::watchSupported;
+
+// These tests watch for files being written in the working directory, so are only meaningful where
+// --watch is supported, and each uses files of its own so they may run alongside each other
+class watchTests final : public testsuite
+{
+private:
+	static void writeFile(const char *const path, const char *const contents) noexcept
+	{
+		auto *const file{fopen(path, "wb")};
+		if (!file)
+			return;
+		fputs(contents, file);
+		fclose(file);
+	}
+
+	void testSettle()
+	{
+		if (!watchSupported)
+			skip("--watch is not supported on this platform");
+		libraryWatcher_t watcher{};
+		assertTrue(watcher.valid());
+		assertTrue(watcher.watch(0, "watchSettle.tmp"));
+		assertTrue(watcher.watch(1, "./watchUntouched.tmp"));
+		std::atomic<bool> written{false};
+		// A rebuild may write the library more than once, which must only be reported once it's done
+		std::thread rebuild{[&]()
+		{
+			for (uint32_t i{0}; i < 3U; ++i)
+			{
+				writeFile("watchSettle.tmp", "library");
+				std::this_thread::sleep_for(std::chrono::milliseconds{10});
+			}
+			written = true;
+		}};
+		const auto libraries{watcher.wait()};
+		rebuild.join();
+		remove("watchSettle.tmp");
+		assertTrue(written);
+		assertEqual(libraries.size(), 1U);
+		assertEqual(libraries[0], 0U);
+	}
+
+	void testMovedIn()
+	{
+		if (!watchSupported)
+			skip("--watch is not supported on this platform");
+		libraryWatcher_t watcher{};
+		assertTrue(watcher.valid());
+		assertTrue(watcher.watch(3, "watchWritten.tmp"));
+		assertTrue(watcher.watch(2, "watchMoved.tmp"));
+		writeFile("watchMoved.new", "library");
+		writeFile("watchWritten.tmp", "library");
+		// A library linked alongside and moved in over the old one must be seen too
+		assertEqual(rename("watchMoved.new", "watchMoved.tmp"), 0);
+		const auto libraries{watcher.wait()};
+		remove("watchMoved.tmp");
+		remove("watchWritten.tmp");
+		assertEqual(libraries.size(), 2U);
+		assertEqual(libraries[0], 2U);
+		assertEqual(libraries[1], 3U);
+	}
+
+public:
+	CRUNCHpp_MAYBE_NOEXCEPT(watchTests()) = default;
+	watchTests(const watchTests &) = delete;
+	watchTests(watchTests &&) = delete;
+	watchTests &operator =(const watchTests &) = delete;
+	watchTests &operator =(watchTests &&) = delete;
+	~watchTests() noexcept final = default;
+
+	void registerTests() final
+	{
+		CRUNCHpp_TEST(testSettle)
+		CRUNCHpp_TEST(testMovedIn)
+	}
+};
+
+CRUNCHpp_TESTS(watchTests)
@@ -8,6 +8,7 @@
 #endif
 #include <string.h>
 #include <float.h>
+#include <math.h>
 
 #include <threading/threadShim.h>
 #include <crunch.h>
@@ -190,11 +191,127 @@ void testAssertStrNotEqual()
 }
 
 void testAssertMemEqual1() { assertMemEqual(testStr1, testStr2, 27); }
+void testAssertMemEqual2()
+{
+	uint8_t bufferA[100] = {0};
+	uint8_t bufferB[100] = {0};
+	bufferB[70] = 1;
+	bufferB[99] = 1;
+	assertMemEqual(bufferA, bufferB, 100);
+}
+
 void testAssertMemEqual()
 {
 	assertMemEqual(testStr1, testStr1, 27);
 	assertMemEqual(testStr2, testStr2, 27);
 	tryShouldFail(testAssertMemEqual1);
+	tryShouldFail(testAssertMemEqual2);
+}
+
+void testAssertRangeEqual1()
+{
+	const uint32_t valuesA[] = {1, 2, 3, 4, 5};
+	const uint32_t valuesB[] = {1, 2, 3, 5, 5};
+	assertRangeEqual(valuesA, valuesB, 5, sizeof(uint32_t));
+}
+
+void testAssertRangeEqual2()
+{
+	uint8_t bytesA[67] = {0};
+	uint8_t bytesB[67] = {0};
+	bytesB[64] = 1;
+	assertRangeEqual(bytesA, bytesB, 67, 1);
+}
+
+void testAssertRangeEqual()
+{
+	uint16_t values[40];
+	for (size_t i = 0; i < 40; ++i)
+		values[i] = (uint16_t)(i * 3U);
+	assertRangeEqual(values, values, 40, sizeof(uint16_t));
+	assertRangeEqual(testStr1, testStr1, 9, 3);
+	tryShouldFail(testAssertRangeEqual1);
+	tryShouldFail(testAssertRangeEqual2);
+}
+
+void testAssertUlpEqual1() { assertFloatUlpEqual(1.0F, 1.0F + (2.0F * FLT_EPSILON), 1); }
+void testAssertUlpEqual2() { assertDoubleUlpEqual(0.0, (double)NAN, 4); }
+void testAssertUlpEqual3()
+{
+	double valuesA[37];
+	double valuesB[37];
+	for (size_t i = 0; i < 37; ++i)
+		valuesA[i] = valuesB[i] = (double)i / 7.0;
+	valuesB[30] += 1e-9;
+	assertDoubleArrayUlpEqual(valuesA, valuesB, 37, 1);
+}
+
+void testAssertUlpEqual()
+{
+	float values[19];
+	for (size_t i = 0; i < 19; ++i)
+		values[i] = (float)i / 3.0F;
+	assertFloatArrayUlpEqual(values, values, 19, 0);
+	assertFloatUlpEqual(1.0F, 1.0F + FLT_EPSILON, 1);
+	assertFloatUlpEqual(-0.0F, 0.0F, 0);
+	assertDoubleUlpEqual((double)INFINITY, (double)INFINITY, 0);
+	assertDoubleUlpEqual(-DBL_MIN, DBL_MIN, UINT64_C(1) << 53U);
+	tryShouldFail(testAssertUlpEqual1);
+	tryShouldFail(testAssertUlpEqual2);
+	tryShouldFail(testAssertUlpEqual3);
+}
+
+void testAssertNear1() { assertDoubleNear(100.0, 102.0, 0.01, 0.0); }
+void testAssertNear2() { assertFloatNear(INFINITY, FLT_MAX, 1.0, 1.0); }
+void testAssertNear3()
+{
+	float valuesA[23];
+	float valuesB[23];
+	for (size_t i = 0; i < 23; ++i)
+		valuesA[i] = valuesB[i] = (float)i;
+	valuesB[5] = 5.5F;
+	valuesB[21] = 30.0F;
+	assertFloatArrayNear(valuesA, valuesB, 23, 0.01, 0.0);
+}
+
+void testAssertNear()
+{
+	double values[23];
+	for (size_t i = 0; i < 23; ++i)
+		values[i] = (double)i * 1.5;
+	assertDoubleArrayNear(values, values, 23, 0.0, 0.0);
+	assertDoubleNear(100.0, 100.5, 0.01, 0.0);
+	assertDoubleNear(0.0, 1e-12, 0.01, 1e-9);
+	assertFloatNear(-INFINITY, -INFINITY, 0.0, 0.0);
+	tryShouldFail(testAssertNear1);
+	tryShouldFail(testAssertNear2);
+	tryShouldFail(testAssertNear3);
+}
+
+void testExpectations()
+{
+	const uint32_t valuesA[] = {1, 2, 3, 4};
+	const uint32_t valuesB[] = {1, 2, 5, 4};
+	expectTrue(TRUE);
+	expectIntEqual(1, 1);
+	expectStringEqual(testStr1, testStr1);
+	expectRangeEqual(valuesA, valuesA, 4, sizeof(uint32_t));
+	expectDoubleNear(100.0, 100.5, 0.01, 0.0);
+	assertFalse(reportExpectations(FALSE));
+	/* Check the test carries on past each expectation that fails, and they all get reported */
+	expectTrue(FALSE);
+	expectIntEqual(1, 2);
+	expectStringEqual(testStr1, testStr2);
+	expectRangeEqual(valuesA, valuesB, 4, sizeof(uint32_t));
+	expectNotNull(NULL);
+	assertTrue(reportExpectations(FALSE));
+	--failures;
+	assertFalse(reportExpectations(FALSE));
+	/* A test that fails an expectation many times over only has the first so many reported in full */
+	for (int32_t i = 0; i < 1000; ++i)
+		expectIntEqual(i, i + 1);
+	assertTrue(reportExpectations(TRUE));
+	assertFalse(reportExpectations(FALSE));
 }
 
 void testAssertMemNotEqual1() { assertMemNotEqual(testStr1, testStr1, 27); }
@@ -358,6 +475,10 @@ BEGIN_REGISTER_TESTS()
 	TEST(testAssertStrEqual)
 	TEST(testAssertStrNotEqual)
 	TEST(testAssertMemEqual)
+	TEST(testAssertRangeEqual)
+	TEST(testAssertUlpEqual)
+	TEST(testAssertNear)
+	TEST(testExpectations)
 	TEST(testAssertMemNotEqual)
 	TEST(testAssertNull)
 	TEST(testAssertNotNull)
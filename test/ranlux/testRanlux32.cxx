@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include <random>
+#include <vector>
 #include <crunch++.h>
 #include "ranlux.h"
 
@@ -29,14 +30,15 @@ private:
 		assertNotNull(crunchRanlux);
 
 		// Check the first 65536 numbers from the two impls are equal..
+		std::vector<uint32_t> stdResults(65536U);
+		std::vector<uint32_t> crunchResults(65536U);
 		for (uint32_t i = 0; i < 65536U; ++i)
 		{
-			const auto stdResult = stdRanlux();
-			const auto crunchResult = genRanlux32(crunchRanlux);
-			assertEqual(crunchResult, stdResult);
+			stdResults[i] = stdRanlux();
+			crunchResults[i] = genRanlux32(crunchRanlux);
 		}
-
 		freeRanlux32(crunchRanlux);
+		assertRangeEqual(crunchResults, stdResults);
 	}
 
 public: